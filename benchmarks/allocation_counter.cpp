@@ -0,0 +1,125 @@
+#include "bench_utilities.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+std::atomic<std::size_t> g_allocations{0};
+std::atomic<std::size_t> g_live_bytes{0};
+std::atomic<std::size_t> g_peak_bytes{0};
+
+// the size of each block is stored in front of it, to know how many bytes are freed
+constexpr std::size_t header_size = alignof(std::max_align_t);
+
+void release(void* ptr) noexcept
+{
+    if(!ptr) return;
+    const auto block = static_cast<char*>(ptr) - header_size;
+    g_live_bytes.fetch_sub(*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+} // namespace
+
+std::size_t Bench::allocationCount()
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+std::size_t Bench::liveBytes()
+{
+    return g_live_bytes.load(std::memory_order_relaxed);
+}
+
+std::size_t Bench::resetPeakBytes()
+{
+    const auto live = liveBytes();
+    g_peak_bytes.store(live, std::memory_order_relaxed);
+    return live;
+}
+
+std::size_t Bench::peakBytes()
+{
+    return g_peak_bytes.load(std::memory_order_relaxed);
+}
+
+void* operator new(const std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if(auto* const block = static_cast<char*>(std::malloc(size + header_size)))
+    {
+        *reinterpret_cast<std::size_t*>(block) = size;
+        const auto live = g_live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        auto peak = g_peak_bytes.load(std::memory_order_relaxed);
+        while(live > peak && !g_peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+        return block + header_size;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new[](const std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    release(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    release(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    release(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    release(ptr);
+}
+
+// std::pmr::new_delete_resource goes through the aligned versions, whose bytes aren't tracked
+void* operator new(const std::size_t size, const std::align_val_t alignment)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+    const auto rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+    if(void* ptr = std::aligned_alloc(align, rounded)) return ptr;
+    throw std::bad_alloc{};
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
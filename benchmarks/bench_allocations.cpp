@@ -0,0 +1,90 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/native_task.hpp>
+
+#include <memory>
+
+namespace
+{
+
+constexpr int nb_stages = 10;
+
+int increment(const int value)
+{
+    return value + 1;
+}
+
+template <class Task> Task chain(Task task)
+{
+    for(int i = 0; i < nb_stages; ++i)
+        task = std::move(task).then(&increment);
+    return task;
+}
+
+int pplxChain(const pplx::task_options& options)
+{
+    return chain(pplx::create_task([]() { return 0; }, options)).get();
+}
+
+int nativeChain(const pplx::task_options& options, std::pmr::memory_resource* resource)
+{
+    const expected_task::native::scoped_memory_resource scoped_resource{resource};
+    return chain(expected_task::native::create_task([]() { return 0; }, options)).get();
+}
+
+} // namespace
+
+TEST_CASE("Allocations per stage, with and without the thread local pool", "[!benchmark][native][allocations]")
+{
+    const pplx::task_options inline_options{std::make_shared<Bench::InlineScheduler>()};
+    const auto pool = expected_task::native::thread_local_pool();
+    const auto heap = std::pmr::new_delete_resource();
+    // the first chain fills the pool of the thread
+    nativeChain(inline_options, pool);
+
+    SECTION("allocations per stage")
+    {
+        const auto perStage = [](const double perChain) { return perChain / (nb_stages + 1); };
+        WARN("pplx::task : " << perStage(Bench::allocationsPerCall([&]() { return pplxChain(inline_options); }))
+                             << " allocations per stage");
+        WARN("native task, new/delete : "
+             << perStage(Bench::allocationsPerCall([&]() { return nativeChain(inline_options, heap); }))
+             << " allocations per stage");
+        WARN("native task, thread local pool : "
+             << perStage(Bench::allocationsPerCall([&]() { return nativeChain(inline_options, pool); }))
+             << " allocations per stage");
+    }
+
+    SECTION("latency of a chain on an inline scheduler")
+    {
+        BENCHMARK("pplx::task")
+        {
+            return pplxChain(inline_options);
+        };
+
+        BENCHMARK("native task, new/delete")
+        {
+            return nativeChain(inline_options, heap);
+        };
+
+        BENCHMARK("native task, thread local pool")
+        {
+            return nativeChain(inline_options, pool);
+        };
+    }
+
+    SECTION("latency of a chain on the ambient scheduler, freeing the stages from other threads")
+    {
+        BENCHMARK("native task, new/delete")
+        {
+            return nativeChain({}, heap);
+        };
+
+        BENCHMARK("native task, thread local pool")
+        {
+            return nativeChain({}, pool);
+        };
+    }
+}
@@ -0,0 +1,48 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/as_completed.hpp>
+
+#include <numeric>
+#include <ranges>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using Task = expected_task::expected_task<std::string, std::wstring>;
+
+/**
+ * @brief shards of 256 bytes each, created as they are gone through.
+ */
+auto shards(const std::size_t size)
+{
+    return std::views::iota(std::size_t{0}, size) | std::views::transform(
+               [](std::size_t) { return Task{expected_task::create_task([]() { return std::string(256, 'a'); })}; });
+}
+
+} // namespace
+
+TEST_CASE("Memory of aggregating shards with fold_async", "[!benchmark][as_completed]")
+{
+    const auto total_size = [](const std::size_t acc, const std::string& shard) { return acc + shard.size(); };
+
+    for(const std::size_t size : {1000, 100000})
+    {
+        const auto suffix = " (" + std::to_string(size) + " shards of 256 bytes)";
+        const auto gathering = [&]()
+        {
+            const auto values = *expected_task::when_all(shards(size)).get();
+            return std::accumulate(begin(values), end(values), std::size_t{0}, total_size);
+        };
+        const auto folding
+            = [&]() { return *expected_task::fold_async(shards(size), std::size_t{0}, total_size).get(); };
+
+        WARN("when_all, then accumulating" << suffix << " : peak of " << Bench::peakBytesDuring(gathering) / 1024
+                                           << " KiB, " << Bench::latencyPercentiles(gathering, 5));
+        WARN("fold_async" << suffix << " : peak of " << Bench::peakBytesDuring(folding) / 1024 << " KiB, "
+                          << Bench::latencyPercentiles(folding, 5));
+    }
+}
@@ -0,0 +1,76 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/batch_loader.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+using Loader = expected_task::batch_loader<int, int>;
+using Expected = typename Loader::expected_type;
+using clock = std::chrono::steady_clock;
+
+/**
+ * @brief loads nb_loads keys, one every interval, and reports the number of calls to a backend answering in 1 ms and
+ * the latencies of the loads.
+ */
+std::string loadAtRate(const clock::duration interval, const expected_task::batch_options& batching,
+                       const std::size_t nb_loads = 1000)
+{
+    Bench::SimulatedBackend backend{1ms};
+    std::atomic<std::size_t> nb_calls{0};
+    std::mutex mutex;
+    std::vector<double> latencies;
+    {
+        Loader loader{[&](std::vector<int> keys) -> Loader::batch_result_type
+                      {
+                          ++nb_calls;
+                          std::vector<Expected> results(keys.begin(), keys.end());
+                          return Loader::batch_result_type{backend.answer(std::move(results))};
+                      },
+                      batching};
+        std::vector<expected_task::expected_task<int, std::wstring>> loads;
+        for(std::size_t i = 0; i < nb_loads; ++i)
+        {
+            const auto start = clock::now();
+            loads.push_back(loader.load(static_cast<int>(i)).then_map(
+                [&, start](const int key)
+                {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    latencies.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+                    return key;
+                }));
+            std::this_thread::sleep_for(interval);
+        }
+        for(const auto& load : loads)
+            load.wait();
+    }
+    std::sort(begin(latencies), end(latencies));
+    const auto at = [&latencies](const double ratio)
+    { return std::to_string(latencies[static_cast<std::size_t>(ratio * static_cast<double>(latencies.size() - 1))]); };
+    return std::to_string(nb_calls) + " backend calls, p50 " + at(0.5) + " ms, p99 " + at(0.99) + " ms";
+}
+
+} // namespace
+
+TEST_CASE("Backend calls and latency of batch_loader at various arrival rates", "[!benchmark][batch_loader]")
+{
+    for(const auto interval : {10us, 100us, 1000us})
+    {
+        const auto suffix = " (1000 loads, one every " + std::to_string(interval.count()) + " us)";
+        WARN("one call per load" << suffix << " : " << loadAtRate(interval, {1, 0ms}));
+        WARN("batches of up to 64 keys within 1 ms" << suffix << " : " << loadAtRate(interval, {64, 1ms}));
+        WARN("batches of up to 64 keys within 5 ms" << suffix << " : " << loadAtRate(interval, {64, 5ms}));
+    }
+}
@@ -0,0 +1,76 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/expected_task.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+using clock = std::chrono::steady_clock;
+
+/**
+ * @brief burns the CPU for the duration, as the processing of a stage would.
+ */
+void spin(const clock::duration duration)
+{
+    const auto end = clock::now() + duration;
+    while(clock::now() < end)
+        ;
+}
+
+/**
+ * @brief nb_requests chains of a backend call answering in 1 ms, followed by 5 stages, each one processing for 100 us
+ * and calling the backend again. Half of the requests are abandoned 2 ms after being started : reports the number of stages run and the time to
+ * serve all of them.
+ */
+std::string abandonHalf(const bool with_tokens, const std::size_t nb_requests = 500)
+{
+    Bench::SimulatedBackend backend{1ms};
+    std::atomic<std::size_t> nb_stages{0};
+    const auto stage = [&](const int value)
+    {
+        ++nb_stages;
+        spin(100us);
+        return Task{backend.answer(Expected{value + 1})};
+    };
+    std::vector<pplx::cancellation_token_source> sources(nb_requests);
+    std::vector<Task> requests;
+    const auto start = clock::now();
+    for(std::size_t i = 0; i < nb_requests; ++i)
+    {
+        const auto options = with_tokens ? pplx::task_options{sources[i].get_token()} : pplx::task_options{};
+        requests.push_back(Task{backend.answer(Expected{0})}
+                               .and_then(stage, options)
+                               .and_then(stage)
+                               .and_then(stage)
+                               .and_then(stage)
+                               .and_then(stage));
+    }
+    std::this_thread::sleep_for(2ms);
+    for(std::size_t i = 0; i < nb_requests; i += 2)
+        sources[i].cancel();
+    for(const auto& request : requests)
+        request.wait();
+    const auto elapsed = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    return std::to_string(nb_stages) + " of " + std::to_string(5 * nb_requests) + " stages run, in "
+           + std::to_string(elapsed) + " ms";
+}
+
+} // namespace
+
+TEST_CASE("Work saved by cancellation tokens when half of the requests are abandoned", "[!benchmark][cancellation]")
+{
+    WARN("without cancellation tokens : " << abandonHalf(false));
+    WARN("with cancellation tokens : " << abandonHalf(true));
+}
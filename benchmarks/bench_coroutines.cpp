@@ -0,0 +1,90 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/coroutine.hpp>
+
+#ifdef EXPECTED_TASK_HAS_COROUTINES
+
+#include <string>
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+
+constexpr std::size_t nb_stages = 20;
+
+Task readyStage(const int value)
+{
+    return Task{value + 1};
+}
+
+Task asyncStage(const int value)
+{
+    return expected_task::create_task([value]() { return value + 1; });
+}
+
+template <class Stage> Task chainWithAndThen(Stage stage)
+{
+    auto task = Task{0};
+    for(std::size_t i = 0; i < nb_stages; ++i)
+        task = task.and_then(stage);
+    return task;
+}
+
+template <class Stage> Task chainWithCoroutine(Stage stage)
+{
+    int value = 0;
+    for(std::size_t i = 0; i < nb_stages; ++i)
+        value = co_await stage(value);
+    co_return value;
+}
+
+int run(const Task& task)
+{
+    return *task.get();
+}
+
+} // namespace
+
+TEST_CASE("20 stages coroutine against the equivalent and_then chain", "[!benchmark][coroutine]")
+{
+    SECTION("allocations per request")
+    {
+        WARN("and_then chain, ready stages : " << Bench::allocationsPerCall([]() { run(chainWithAndThen(&readyStage)); })
+                                               << " allocations per request");
+        WARN("coroutine, ready stages : " << Bench::allocationsPerCall([]() { run(chainWithCoroutine(&readyStage)); })
+                                          << " allocations per request");
+        WARN("and_then chain, asynchronous stages : "
+             << Bench::allocationsPerCall([]() { run(chainWithAndThen(&asyncStage)); }) << " allocations per request");
+        WARN("coroutine, asynchronous stages : "
+             << Bench::allocationsPerCall([]() { run(chainWithCoroutine(&asyncStage)); })
+             << " allocations per request");
+    }
+
+    SECTION("latency")
+    {
+        BENCHMARK("and_then chain, ready stages")
+        {
+            return run(chainWithAndThen(&readyStage));
+        };
+
+        BENCHMARK("coroutine, ready stages")
+        {
+            return run(chainWithCoroutine(&readyStage));
+        };
+
+        BENCHMARK("and_then chain, asynchronous stages")
+        {
+            return run(chainWithAndThen(&asyncStage));
+        };
+
+        BENCHMARK("coroutine, asynchronous stages")
+        {
+            return run(chainWithCoroutine(&asyncStage));
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,70 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+#include "utilities.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+
+Task makeFailingRequest()
+{
+    return pplx::create_task([]() -> Task::expected_type { return tl::make_unexpected(L"backend down"); });
+}
+
+template <class Recovery> std::size_t runErrorStorm(const std::size_t nb_requests, Recovery recovery)
+{
+    std::vector<pplx::task<int>> requests;
+    requests.reserve(nb_requests);
+    for(std::size_t i = 0; i < nb_requests; ++i)
+        requests.push_back(recovery(makeFailingRequest()));
+    std::size_t recovered = 0;
+    for(auto& request : requests)
+        recovered += static_cast<std::size_t>(request.get());
+    return recovered;
+}
+
+} // namespace
+
+TEST_CASE("Error storm recovered asynchronously on a small pool", "[!benchmark][error]")
+{
+    const auto pool = std::make_shared<Testing::FixedThreadPool>(2);
+    const Testing::ScopedAmbientScheduler scoped_scheduler{pool};
+    Bench::SimulatedBackend fallback_cache{1ms};
+
+    for(const std::size_t nb_requests : {100, 1000})
+    {
+        const auto suffix = " (" + std::to_string(nb_requests) + " failed requests, 2 threads, 1ms fallback)";
+
+        BENCHMARK("or_else with a task-returning fallback" + suffix)
+        {
+            return runErrorStorm(nb_requests,
+                                 [&fallback_cache](Task request)
+                                 {
+                                     return request
+                                         .or_else([&fallback_cache](std::wstring)
+                                                  { return fallback_cache.answer(Task::expected_type{1}); })
+                                         .then_return_value_or_convert_error_to_value([](std::wstring) { return 0; });
+                                 });
+        };
+
+        BENCHMARK("map_error + then_return_value_or_convert_error_to_value with task-returning fallbacks" + suffix)
+        {
+            return runErrorStorm(nb_requests,
+                                 [&fallback_cache](Task request)
+                                 {
+                                     return request
+                                         .map_error([&fallback_cache](std::wstring error)
+                                                    { return fallback_cache.answer(L"cached: " + error); })
+                                         .then_return_value_or_convert_error_to_value(
+                                             [&fallback_cache](std::wstring) { return fallback_cache.answer(1); });
+                                 });
+        };
+    }
+}
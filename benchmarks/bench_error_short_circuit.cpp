@@ -0,0 +1,94 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+#include "utilities.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+
+constexpr std::size_t nb_stages = 20;
+
+Task makeFailingRequest()
+{
+    return pplx::create_task([]() -> Task::expected_type
+                             { return tl::make_unexpected(L"backend down, the whole error message being copied"); });
+}
+
+int increment(const int value)
+{
+    return value + 1;
+}
+
+Task deepChain()
+{
+    auto task = makeFailingRequest();
+    for(std::size_t i = 0; i < nb_stages; ++i)
+        task = task.then_map(&increment);
+    return task;
+}
+
+/**
+ * @brief the same chain, written with plain pplx continuations forwarding the error at each stage
+ */
+Task deepChainForwardingErrors()
+{
+    auto task = makeFailingRequest().to_task();
+    for(std::size_t i = 0; i < nb_stages; ++i)
+        task = task.then([](Task::expected_type res) { return res.map(&increment); });
+    return task;
+}
+
+template <class Chain> std::size_t runRequests(const std::size_t nb_requests, Chain chain)
+{
+    std::vector<Task> requests;
+    requests.reserve(nb_requests);
+    for(std::size_t i = 0; i < nb_requests; ++i)
+        requests.push_back(chain().or_else([](std::wstring) -> Task::expected_type { return 0; }));
+    std::size_t recovered = 0;
+    for(auto& request : requests)
+        recovered += static_cast<std::size_t>(request.get().has_value());
+    return recovered;
+}
+
+} // namespace
+
+TEST_CASE("Deep chains at a 100% error rate", "[!benchmark][error]")
+{
+    const auto pool = std::make_shared<Testing::FixedThreadPool>(2);
+    const Testing::ScopedAmbientScheduler scoped_scheduler{pool};
+    const std::size_t nb_requests = 1000;
+
+    SECTION("scheduled jobs per request")
+    {
+        const auto scheduled_per_request = [&pool, nb_requests](auto chain)
+        {
+            const auto before = pool->scheduledCount();
+            runRequests(nb_requests, chain);
+            return static_cast<double>(pool->scheduledCount() - before) / static_cast<double>(nb_requests);
+        };
+        WARN("short-circuited chain : " << scheduled_per_request(&deepChain) << " jobs per request");
+        WARN("errors forwarded by each stage : " << scheduled_per_request(&deepChainForwardingErrors)
+                                                 << " jobs per request");
+    }
+
+    SECTION("throughput")
+    {
+        const auto suffix = " (" + std::to_string(nb_requests) + " failed requests, " + std::to_string(nb_stages)
+                            + " stages, 2 threads)";
+
+        BENCHMARK("short-circuited chain" + suffix)
+        {
+            return runRequests(nb_requests, &deepChain);
+        };
+
+        BENCHMARK("errors forwarded by each stage" + suffix)
+        {
+            return runRequests(nb_requests, &deepChainForwardingErrors);
+        };
+    }
+}
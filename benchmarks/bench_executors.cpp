@@ -0,0 +1,72 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+#include "utilities.hpp"
+
+#include <expected_task/when_all.hpp>
+#include <expected_task/work_stealing_executor.hpp>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using Task = expected_task::expected_task<std::uint64_t, std::wstring>;
+
+constexpr std::size_t nb_requests = 2000;
+constexpr std::size_t nb_stages = 8;
+
+/**
+ * @brief a small CPU bound stage
+ */
+std::uint64_t work(std::uint64_t value)
+{
+    for(std::size_t i = 0; i < 2000; ++i)
+        value = value * 6364136223846793005ull + 1442695040888963407ull;
+    return value;
+}
+
+std::size_t runRequests(const pplx::task_options& options)
+{
+    std::vector<Task> requests;
+    requests.reserve(nb_requests);
+    for(std::size_t i = 0; i < nb_requests; ++i)
+    {
+        auto request = expected_task::create_task([i]() { return work(i); }, options);
+        for(std::size_t stage = 0; stage < nb_stages; ++stage)
+            request = request.then_map(&work);
+        requests.push_back(std::move(request));
+    }
+    return when_all(requests, options).get()->size();
+}
+
+} // namespace
+
+TEST_CASE("Throughput of the schedulers", "[!benchmark][executor]")
+{
+    const auto suffix = " (" + std::to_string(nb_requests) + " requests of " + std::to_string(nb_stages + 1)
+                        + " CPU bound stages)";
+
+    BENCHMARK("default pplx scheduler" + suffix)
+    {
+        return runRequests(pplx::get_ambient_scheduler());
+    };
+
+    for(const std::size_t nb_threads : {1, 2, 4, 8, 16, 32, 64})
+    {
+        const auto threads = ", " + std::to_string(nb_threads) + " threads";
+        const auto work_stealing = std::make_shared<expected_task::work_stealing_executor>(nb_threads);
+        const auto single_queue = std::make_shared<Testing::FixedThreadPool>(nb_threads);
+
+        BENCHMARK("work stealing executor" + suffix + threads)
+        {
+            return runRequests(work_stealing);
+        };
+
+        BENCHMARK("single queue pool" + suffix + threads)
+        {
+            return runRequests(single_queue);
+        };
+    }
+}
@@ -0,0 +1,115 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/hedge.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <string>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+
+/**
+ * @brief a backend with a heavy tailed latency : 97 % of the answers come in 0.8 to 1.5 ms, the others follow a
+ * Pareto distribution from 10 ms, capped at 200 ms. The answers are delivered by timers of its own wheel.
+ */
+class HeavyTailedBackend
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit HeavyTailedBackend(expected_task::timer_wheel& wheel)
+        : m_wheel{wheel}
+    {
+    }
+
+    Task answer(const int value)
+    {
+        expected_task::backend::task_completion_event<Expected> event;
+        m_wheel.schedule_after(latency(), [event, value]() { event.set(Expected{value}); });
+        return Task{expected_task::backend::create_task(event)};
+    }
+
+private:
+    expected_task::timer_wheel& m_wheel;
+    std::mutex m_mutex;
+    std::mt19937 m_generator{42};
+
+    clock::duration latency()
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        std::uniform_real_distribution<double> uniform{0., 1.};
+        if(uniform(m_generator) < 0.97)
+            return std::chrono::duration_cast<clock::duration>(std::chrono::duration<double, std::milli>(
+                0.8 + 0.7 * uniform(m_generator)));
+        const auto tail = 10. * std::pow(1. - uniform(m_generator), -1. / 1.5);
+        return std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double, std::milli>(std::min(tail, 200.)));
+    }
+};
+
+} // namespace
+
+TEST_CASE("Tail latency of hedge, against a backend with a heavy tailed latency", "[!benchmark][hedge]")
+{
+    constexpr std::size_t nb_requests = 2000;
+    expected_task::timer_wheel wheel{100us};
+    HeavyTailedBackend backend{wheel};
+    std::atomic<std::size_t> nb_answers{0};
+    std::atomic<std::size_t> nb_parsed{0};
+    // the stage following each answer, skipped by the losers
+    const auto request = [&](const pplx::cancellation_token& token)
+    {
+        ++nb_answers;
+        return backend.answer(1).with_cancellation(token).then_map(
+            [&nb_parsed](const int value)
+            {
+                ++nb_parsed;
+                return value;
+            });
+    };
+
+    const auto direct = [&]() { request(pplx::cancellation_token::none()).wait(); };
+    WARN("without hedging : " << Bench::latencyPercentiles(direct, nb_requests));
+
+    const auto run = [&](const std::string& name, expected_task::hedge_policy policy, const std::size_t max_hedges)
+    {
+        nb_answers = 0;
+        nb_parsed = 0;
+        const auto hedged = [&]() { expected_task::hedge(request, policy, max_hedges, {}, wheel).wait(); };
+        const auto latencies = Bench::latencyPercentiles(hedged, nb_requests);
+        const auto statistics = policy.statistics();
+        const auto delay = std::chrono::duration<double, std::milli>(policy.delay()).count();
+        WARN(name << " : " << latencies << ", " << statistics.hedges << " hedges fired for " << statistics.calls
+                  << " calls (" << statistics.hedge_wins << " won), final delay " << delay << " ms, "
+                  << nb_answers - nb_parsed << " loser stages skipped");
+    };
+    run("fixed delay of 5 ms, 1 hedge", 5ms, 1);
+    run("adaptive p95, 1 hedge", expected_task::hedge_policy::adaptive(0.95, 5ms), 1);
+    run("adaptive p95, 2 hedges", expected_task::hedge_policy::adaptive(0.95, 5ms), 2);
+    run("adaptive p99, 1 hedge", expected_task::hedge_policy::adaptive(0.99, 5ms), 1);
+}
+
+TEST_CASE("Overhead of hedge when no hedge fires", "[!benchmark][hedge]")
+{
+    const auto ready = []() { return Task{1}; };
+    const expected_task::hedge_policy policy{1h};
+    WARN("ready attempt : " << Bench::allocationsPerCall([&]() { expected_task::hedge(ready, policy).wait(); })
+                            << " allocations per call");
+    Bench::SimulatedBackend backend{100us};
+    const auto slow = [&]() { return Task{backend.answer(Expected{1})}; };
+    WARN("attempt answered in 100 us : "
+         << Bench::allocationsPerCall([&]() { expected_task::hedge(slow, policy).wait(); }) << " allocations per call, "
+         << Bench::latencyPercentiles([&]() { expected_task::hedge(slow, policy).wait(); }, 1000));
+}
@@ -0,0 +1,67 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/loop.hpp>
+
+#include <chrono>
+#include <string>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+
+/**
+ * @brief the pagination written by hand : each page nests the request of the next one in an and_then.
+ */
+template <class Fetch> Task paginateByHand(const Fetch& fetch, const int page, const int nb_pages)
+{
+    return fetch(page).and_then(
+        [&fetch, nb_pages](const int next) -> Task
+        {
+            if(next >= nb_pages) return next;
+            return paginateByHand(fetch, next, nb_pages);
+        });
+}
+
+} // namespace
+
+TEST_CASE("Memory of while_async against nested and_then, fetching pages from a backend", "[!benchmark][loop]")
+{
+    Bench::SimulatedBackend backend{20us};
+    const auto fetch = [&backend](const int page) { return Task{backend.answer(Expected{page + 1})}; };
+
+    for(const int nb_pages : {100, 1000, 10000})
+    {
+        const auto suffix = " (" + std::to_string(nb_pages) + " pages) : peak of ";
+        const auto byHand = [&]() { paginateByHand(fetch, 0, nb_pages).wait(); };
+        WARN("nested and_then" << suffix << Bench::peakBytesDuring(byHand) << " bytes, "
+                               << Bench::latencyPercentiles(byHand, 3));
+        const auto loop = [&]()
+        {
+            expected_task::while_async(
+                0, [nb_pages](const int page) { return page < nb_pages; }, fetch)
+                .wait();
+        };
+        WARN("while_async" << suffix << Bench::peakBytesDuring(loop) << " bytes, "
+                           << Bench::latencyPercentiles(loop, 3));
+    }
+}
+
+TEST_CASE("Cost of an iteration of while_async", "[!benchmark][loop]")
+{
+    const auto ready = [](const int i) { return Task{i + 1}; };
+    const auto immediate = [&]()
+    { expected_task::while_async(0, [](const int i) { return i < 1000000; }, ready).wait(); };
+    WARN("1000000 iterations done right away : peak of " << Bench::peakBytesDuring(immediate) << " bytes, "
+                                                         << Bench::latencyPercentiles(immediate, 3));
+    const auto asynchronous = [](const int i) { return expected_task::create_task([i]() { return i + 1; }); };
+    const auto scheduled = [&]()
+    { expected_task::while_async(0, [](const int i) { return i < 10000; }, asynchronous).wait(); };
+    WARN("10000 iterations on the scheduler : peak of " << Bench::peakBytesDuring(scheduled) << " bytes, "
+                                                        << Bench::latencyPercentiles(scheduled, 3));
+}
@@ -0,0 +1,106 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/memoized.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+using Memoized = expected_task::memoized<int, int>;
+using clock = std::chrono::steady_clock;
+
+/**
+ * @brief keys drawn with a skewed distribution, most of the traffic going to a few hot keys.
+ */
+std::vector<int> skewedKeys(const std::size_t nb_keys, const int key_space, const unsigned seed)
+{
+    std::mt19937 generator{seed};
+    std::geometric_distribution<int> distribution{0.05};
+    std::vector<int> keys(nb_keys);
+    for(auto& key : keys)
+        key = distribution(generator) % key_space;
+    return keys;
+}
+
+/**
+ * @brief nb_threads threads looking up skewed keys in a memoized over a backend answering in 1 ms, and waiting for
+ * each result : reports the backend calls and the hit rate.
+ */
+std::string hitRate(const std::size_t nb_threads, const std::size_t nb_lookups = 2000)
+{
+    Bench::SimulatedBackend backend{1ms};
+    std::atomic<std::size_t> nb_calls{0};
+    Memoized memoized{[&](const int key)
+                      {
+                          ++nb_calls;
+                          return Task{backend.answer(Task::expected_type{key})};
+                      }};
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i < nb_threads; ++i)
+        threads.emplace_back(
+            [&, i]()
+            {
+                for(const auto key : skewedKeys(nb_lookups, 1000, static_cast<unsigned>(i)))
+                    memoized(key).wait();
+            });
+    for(auto& thread : threads)
+        thread.join();
+    const auto statistics = memoized.statistics();
+    const auto nb_total = statistics.hits + statistics.joins + statistics.misses;
+    return std::to_string(nb_calls) + " backend calls for " + std::to_string(nb_total) + " lookups, "
+           + std::to_string(100. * static_cast<double>(statistics.hits) / static_cast<double>(nb_total)) + " % hits, "
+           + std::to_string(statistics.joins) + " joins";
+}
+
+/**
+ * @brief lookups per second of nb_threads threads hitting a warm cache of 1000 keys, where the only cost left is the
+ * locking of the shards.
+ */
+std::string hitThroughput(const std::size_t nb_threads, const std::size_t nb_shards,
+                          const std::size_t nb_lookups = 200000)
+{
+    Memoized memoized{[](const int key) { return Task{key}; }, {10000, 1h, 1s, nb_shards}};
+    for(int key = 0; key < 1000; ++key)
+        memoized(key).wait();
+    std::vector<std::thread> threads;
+    const auto start = clock::now();
+    for(std::size_t i = 0; i < nb_threads; ++i)
+        threads.emplace_back(
+            [&, i]()
+            {
+                for(const auto key : skewedKeys(nb_lookups, 1000, static_cast<unsigned>(i)))
+                    memoized(key).get();
+            });
+    for(auto& thread : threads)
+        thread.join();
+    const auto elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    return std::to_string(static_cast<double>(nb_threads * nb_lookups) / elapsed / 1e6) + " M lookups/s";
+}
+
+} // namespace
+
+TEST_CASE("Hit rate of memoized on skewed keys", "[!benchmark][memoized]")
+{
+    for(const std::size_t nb_threads : {1, 4, 16})
+        WARN(nb_threads << " threads, 2000 lookups each : " << hitRate(nb_threads));
+}
+
+TEST_CASE("Contention of memoized on cache hits", "[!benchmark][memoized]")
+{
+    for(const std::size_t nb_threads : {1, 4, 16})
+    {
+        WARN(nb_threads << " threads, 1 shard : " << hitThroughput(nb_threads, 1));
+        WARN(nb_threads << " threads, 16 shards : " << hitThroughput(nb_threads, 16));
+    }
+}
@@ -0,0 +1,73 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/native_task.hpp>
+
+#include <memory>
+
+namespace
+{
+
+int increment(const int value)
+{
+    return value + 1;
+}
+
+template <class Task> Task chain(Task task)
+{
+    for(int i = 0; i < 8; ++i)
+        task = task.then(&increment);
+    return task;
+}
+
+int pplxChain(const pplx::task_options& options)
+{
+    return chain(pplx::create_task([]() { return 0; }, options)).get();
+}
+
+int nativeChain(const pplx::task_options& options)
+{
+    return chain(expected_task::native::create_task([]() { return 0; }, options)).get();
+}
+
+} // namespace
+
+TEST_CASE("8 asynchronous stages on pplx::task against the native engine", "[!benchmark][native]")
+{
+    const pplx::task_options inline_options{std::make_shared<Bench::InlineScheduler>()};
+    const auto pplxInline = [&inline_options]() { return pplxChain(inline_options); };
+    const auto nativeInline = [&inline_options]() { return nativeChain(inline_options); };
+
+    SECTION("allocations per request")
+    {
+        WARN("pplx::task : " << Bench::allocationsPerCall(pplxInline) << " allocations per request");
+        WARN("native task : " << Bench::allocationsPerCall(nativeInline) << " allocations per request");
+    }
+
+    SECTION("latency of the engine alone, on an inline scheduler")
+    {
+        BENCHMARK("pplx::task")
+        {
+            return pplxInline();
+        };
+
+        BENCHMARK("native task")
+        {
+            return nativeInline();
+        };
+    }
+
+    SECTION("latency on the ambient scheduler")
+    {
+        BENCHMARK("pplx::task")
+        {
+            return pplxChain({});
+        };
+
+        BENCHMARK("native task")
+        {
+            return nativeChain({});
+        };
+    }
+}
@@ -0,0 +1,67 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/pipeline.hpp>
+
+#include <string>
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+
+Task asyncSource()
+{
+    return expected_task::create_task([]() { return 0; });
+}
+
+int increment(const int value)
+{
+    return value + 1;
+}
+
+int chainedStages()
+{
+    return *asyncSource()
+                .then_map(&increment)
+                .then_map(&increment)
+                .then_map(&increment)
+                .then_map(&increment)
+                .then_map(&increment)
+                .then_map(&increment)
+                .then_map(&increment)
+                .then_map(&increment)
+                .get();
+}
+
+int fusedStages()
+{
+    return *(expected_task::pipeline{asyncSource()} >= &increment >= &increment >= &increment >= &increment
+             >= &increment >= &increment >= &increment >= &increment)
+                .get();
+}
+
+} // namespace
+
+TEST_CASE("8 synchronous stages chained against fused in a pipeline", "[!benchmark][pipeline]")
+{
+    SECTION("allocations per request")
+    {
+        WARN("chained then_map : " << Bench::allocationsPerCall(&chainedStages) << " allocations per request");
+        WARN("pipeline : " << Bench::allocationsPerCall(&fusedStages) << " allocations per request");
+    }
+
+    SECTION("latency")
+    {
+        BENCHMARK("chained then_map")
+        {
+            return chainedStages();
+        };
+
+        BENCHMARK("pipeline")
+        {
+            return fusedStages();
+        };
+    }
+}
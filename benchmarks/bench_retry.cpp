@@ -0,0 +1,64 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/retry.hpp>
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+using namespace std::chrono_literals;
+using namespace std::string_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+using Policy = expected_task::retry_policy<std::wstring>;
+
+/**
+ * @brief the retries written by hand : each attempt nests the next one in an or_else.
+ */
+Task retryByHand(const std::function<Task()>& factory, const std::size_t nb_attempts)
+{
+    return factory().or_else(
+        [factory, nb_attempts](std::wstring error) -> Task
+        {
+            if(nb_attempts <= 1) return tl::make_unexpected(std::move(error));
+            return retryByHand(factory, nb_attempts - 1);
+        });
+}
+
+} // namespace
+
+TEST_CASE("Memory of retry against nested or_else, with a backend always failing", "[!benchmark][retry]")
+{
+    Bench::SimulatedBackend backend{100us};
+    const std::function<Task()> failing = [&backend]()
+    { return Task{backend.answer(Expected{tl::make_unexpected(L"error"s)})}; };
+
+    for(const std::size_t nb_attempts : {10, 100, 1000})
+    {
+        const auto suffix = " (" + std::to_string(nb_attempts) + " attempts) : peak of ";
+        const auto byHand = [&]() { retryByHand(failing, nb_attempts).wait(); };
+        WARN("nested or_else" << suffix << Bench::peakBytesDuring(byHand) << " bytes, "
+                              << Bench::latencyPercentiles(byHand, 3));
+        const auto combinator = [&]()
+        { expected_task::retry(failing, Policy{.max_attempts = nb_attempts, .initial_delay = 0ms}).wait(); };
+        WARN("retry" << suffix << Bench::peakBytesDuring(combinator) << " bytes, "
+                     << Bench::latencyPercentiles(combinator, 3));
+    }
+}
+
+TEST_CASE("Cost of an attempt of retry", "[!benchmark][retry]")
+{
+    const auto failing = []() { return Task{tl::make_unexpected(L"error"s)}; };
+    const auto immediate = [&]()
+    { expected_task::retry(failing, Policy{.max_attempts = 100000, .initial_delay = 0ms}).wait(); };
+    WARN("100000 attempts failing right away, without delay : " << Bench::latencyPercentiles(immediate, 5));
+    const auto delayed = [&]()
+    { expected_task::retry(failing, Policy{.max_attempts = 10, .initial_delay = 1ms, .multiplier = 1.}).wait(); };
+    WARN("10 attempts 1 ms apart, on the shared timer wheel : " << Bench::latencyPercentiles(delayed, 5));
+}
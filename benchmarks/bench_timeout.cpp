@@ -0,0 +1,132 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/timeout.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using namespace std::string_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+using Event = expected_task::backend::task_completion_event<Expected>;
+using clock = expected_task::timer_wheel::clock;
+
+/**
+ * @brief a timer of the benchmark : its deadline, and how late it expired.
+ */
+struct Record
+{
+    clock::time_point deadline;
+    std::chrono::duration<double, std::milli> lateness{-1.};
+};
+
+std::string nsPer(const clock::duration elapsed, const std::size_t count)
+{
+    return std::to_string(std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(count))
+           + " ns";
+}
+
+} // namespace
+
+TEST_CASE("Scheduling, cancelling and expiring 1M concurrent timers", "[!benchmark][timeout]")
+{
+    constexpr std::size_t nb_timers = 1'000'000;
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> delays{1000, 2000};
+    std::vector<Record> records(nb_timers);
+    for(auto& record : records)
+        record.deadline = clock::now() + std::chrono::milliseconds{delays(generator)};
+
+    SECTION("expiring")
+    {
+        expected_task::timer_wheel wheel;
+        std::atomic<std::size_t> nb_expired{0};
+        const auto before = Bench::liveBytes();
+        const auto start = clock::now();
+        for(auto& record : records)
+            wheel.schedule_at(record.deadline,
+                              [&nb_expired, record = &record]()
+                              {
+                                  record->lateness = clock::now() - record->deadline;
+                                  nb_expired.fetch_add(1, std::memory_order_relaxed);
+                              });
+        const auto scheduling = clock::now() - start;
+        const auto bytes = Bench::liveBytes() - before;
+        while(nb_expired.load() != nb_timers)
+            std::this_thread::sleep_for(10ms);
+        std::vector<double> lateness;
+        lateness.reserve(nb_timers);
+        for(const auto& record : records)
+            lateness.push_back(record.lateness.count());
+        std::sort(begin(lateness), end(lateness));
+        WARN("scheduling 1M timers over 1 to 2 s : " << nsPer(scheduling, nb_timers) << " per timer, "
+                                                      << bytes / nb_timers << " bytes per timer");
+        WARN("lateness of 1M timers with a 1 ms tick : p50 " << lateness[nb_timers / 2] << " ms, p99 "
+                                                             << lateness[nb_timers * 99 / 100] << " ms, max "
+                                                             << lateness.back() << " ms, min " << lateness.front()
+                                                             << " ms");
+    }
+
+    SECTION("cancelling")
+    {
+        expected_task::timer_wheel wheel;
+        std::vector<expected_task::timer_id> timers;
+        timers.reserve(nb_timers);
+        for(const auto& record : records)
+            timers.push_back(wheel.schedule_at(record.deadline, []() {}));
+        const auto start = clock::now();
+        for(const auto timer : timers)
+            wheel.cancel(timer);
+        WARN("cancelling 1M pending timers : " << nsPer(clock::now() - start, nb_timers) << " per timer");
+    }
+}
+
+TEST_CASE("Overhead of with_timeout on tasks finishing in time", "[!benchmark][timeout]")
+{
+    constexpr std::size_t nb_tasks = 10000;
+    const auto run = [](const bool bounded)
+    {
+        std::vector<Event> events(nb_tasks);
+        std::vector<Task> tasks;
+        tasks.reserve(nb_tasks);
+        for(const auto& event : events)
+        {
+            Task task{expected_task::backend::create_task(event)};
+            tasks.push_back(bounded ? with_timeout(std::move(task), 10s, L"timeout"s) : std::move(task));
+        }
+        for(const auto& event : events)
+            event.set(Expected{1});
+        for(const auto& task : tasks)
+            task.wait();
+    };
+    WARN("10000 tasks without timeout : " << Bench::latencyPercentiles([&]() { run(false); }, 5));
+    WARN("10000 tasks with a timeout : " << Bench::latencyPercentiles([&]() { run(true); }, 5));
+    const auto pending = []()
+    {
+        Event event;
+        const auto task = with_timeout(Task{expected_task::backend::create_task(event)}, 10s, L"timeout"s);
+        event.set(Expected{1});
+        task.wait();
+    };
+    const auto pendingAlone = []()
+    {
+        Event event;
+        const Task task{expected_task::backend::create_task(event)};
+        event.set(Expected{1});
+        task.wait();
+    };
+    WARN("allocations of with_timeout per pending task : "
+         << Bench::allocationsPerCall(pending, 1000) - Bench::allocationsPerCall(pendingAlone, 1000));
+}
@@ -0,0 +1,50 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/transform_async.hpp>
+#include <expected_task/when_all.hpp>
+
+#include <chrono>
+#include <ranges>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<std::string, std::wstring>;
+using Expected = typename Task::expected_type;
+
+} // namespace
+
+TEST_CASE("Throughput and memory of transform_async against launching everything", "[!benchmark][transform_async]")
+{
+    Bench::SimulatedBackend backend{1ms};
+    const auto request = [&backend](const int) { return Task{backend.answer(Expected{std::string(64, 'a')})}; };
+
+    for(const int size : {1000, 20000})
+    {
+        const auto suffix = " (" + std::to_string(size) + " requests answered in 1 ms)";
+        const auto launchingAll = [&]()
+        {
+            std::vector<Task> tasks;
+            for(int i = 0; i < size; ++i)
+                tasks.push_back(request(i));
+            return when_all(std::move(tasks)).get();
+        };
+        WARN("creating all the tasks, then when_all" << suffix << " : peak of "
+                                                     << Bench::peakBytesDuring(launchingAll) / 1024 << " KiB, "
+                                                     << Bench::latencyPercentiles(launchingAll, 3));
+        for(const std::size_t max_in_flight : {16, 256})
+        {
+            const auto bounded = [&]()
+            { return expected_task::transform_async(std::views::iota(0, size), request, max_in_flight).get(); };
+            WARN("transform_async, " << max_in_flight << " in flight" << suffix << " : peak of "
+                                     << Bench::peakBytesDuring(bounded) / 1024 << " KiB, "
+                                     << Bench::latencyPercentiles(bounded, 3));
+        }
+    }
+}
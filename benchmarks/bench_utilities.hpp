@@ -0,0 +1,163 @@
+#pragma once
+
+#include <expected_task/expected_task.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Bench
+{
+
+/**
+ * @brief number of calls to the global operator new since the start of the program.
+ */
+std::size_t allocationCount();
+
+/**
+ * @brief bytes allocated with the global operator new and not freed yet.
+ */
+std::size_t liveBytes();
+
+/**
+ * @brief starts tracking the peak of the live bytes from now on, and returns the current live bytes.
+ */
+std::size_t resetPeakBytes();
+
+std::size_t peakBytes();
+
+/**
+ * @brief peak of the memory allocated while calling fct, on top of what was already allocated.
+ */
+template <class FCT> std::size_t peakBytesDuring(FCT&& fct)
+{
+    const auto before = resetPeakBytes();
+    fct();
+    return peakBytes() - before;
+}
+
+/**
+ * @brief average number of allocations made by one call to fct, over nb_runs calls.
+ *
+ * Only meaningful when nothing else allocates meanwhile : the call must be finished (and its tasks released) when fct
+ * returns.
+ */
+template <class FCT> double allocationsPerCall(FCT&& fct, const std::size_t nb_runs = 100)
+{
+    const auto before = allocationCount();
+    for(std::size_t i = 0; i < nb_runs; ++i)
+        fct();
+    return static_cast<double>(allocationCount() - before) / static_cast<double>(nb_runs);
+}
+
+/**
+ * @brief p50, p99 and max latencies of nb_runs calls to fct, for a WARN report.
+ */
+template <class FCT> std::string latencyPercentiles(FCT&& fct, const std::size_t nb_runs = 100)
+{
+    using clock = std::chrono::steady_clock;
+    std::vector<double> latencies;
+    latencies.reserve(nb_runs);
+    for(std::size_t i = 0; i < nb_runs; ++i)
+    {
+        const auto start = clock::now();
+        fct();
+        latencies.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+    }
+    std::sort(begin(latencies), end(latencies));
+    const auto at = [&latencies](const double ratio)
+    { return std::to_string(latencies[static_cast<std::size_t>(ratio * static_cast<double>(latencies.size() - 1))]); };
+    return "p50 " + at(0.5) + " ms, p99 " + at(0.99) + " ms, max " + at(1.) + " ms";
+}
+
+/**
+ * @brief runs the jobs on the calling thread, leaving only the cost of the task engine itself.
+ */
+class InlineScheduler : public pplx::scheduler_interface
+{
+public:
+    void schedule(pplx::TaskProc_t proc, void* param) override
+    {
+        proc(param);
+    }
+};
+
+/**
+ * @brief simulates an I/O bound backend : answers are delivered by a dedicated thread after a fixed latency, without
+ * using any thread of the pplx scheduler while waiting.
+ */
+class SimulatedBackend
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit SimulatedBackend(const clock::duration latency)
+        : m_latency{latency}
+        , m_thread{[this]() { run(); }}
+    {
+    }
+
+    ~SimulatedBackend()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_stopping = true;
+        }
+        m_condition.notify_one();
+        m_thread.join();
+    }
+
+    template <class T> pplx::task<T> answer(T value)
+    {
+        pplx::task_completion_event<T> event;
+        push([event, value = std::move(value)]() { event.set(value); });
+        return pplx::create_task(event);
+    }
+
+private:
+    const clock::duration m_latency;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    // the latency is constant, so the queue is always sorted by deadline
+    std::deque<std::pair<clock::time_point, std::function<void()>>> m_pending;
+    bool m_stopping = false;
+    std::thread m_thread;
+
+    void push(std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_pending.emplace_back(clock::now() + m_latency, std::move(job));
+        }
+        m_condition.notify_one();
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        while(true)
+        {
+            m_condition.wait(lock, [this]() { return m_stopping || !m_pending.empty(); });
+            if(m_pending.empty()) return;
+            const auto deadline = m_pending.front().first;
+            if(clock::now() < deadline)
+            {
+                m_condition.wait_until(lock, deadline);
+                continue;
+            }
+            auto job = std::move(m_pending.front().second);
+            m_pending.pop_front();
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+    }
+};
+
+} // namespace Bench
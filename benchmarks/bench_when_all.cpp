@@ -0,0 +1,110 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/when_all.hpp>
+
+#include <chrono>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+
+/**
+ * @brief a fan-out where the first member fails right away, and all the others answer after the backend's latency.
+ */
+std::vector<Task> fanOut(Bench::SimulatedBackend& slow_backend, const std::size_t size)
+{
+    std::vector<Task> tasks;
+    tasks.reserve(size);
+    tasks.push_back(Task{tl::make_unexpected(std::wstring{L"error"})});
+    for(std::size_t i = 1; i < size; ++i)
+        tasks.push_back(Task{slow_backend.answer(Expected{static_cast<int>(i)})});
+    return tasks;
+}
+
+using LargeTask = expected_task::expected_task<std::string, std::wstring>;
+
+/**
+ * @brief a fan-out of tasks already holding 256 bytes values.
+ */
+std::vector<LargeTask> largeFanOut(const std::size_t size)
+{
+    std::vector<LargeTask> tasks;
+    tasks.reserve(size);
+    for(std::size_t i = 0; i < size; ++i)
+        tasks.emplace_back(std::string(256, 'a'));
+    return tasks;
+}
+
+} // namespace
+
+TEST_CASE("Latency of when_all when one member fails immediately", "[!benchmark][when_all]")
+{
+    Bench::SimulatedBackend slow_backend{20ms};
+
+    for(const std::size_t size : {10, 100, 500})
+    {
+        const auto suffix = " (" + std::to_string(size) + " tasks, one failing immediately, the others in 20 ms)";
+        WARN("aggregating all the errors" << suffix << " : " << Bench::latencyPercentiles(
+                 [&]() { return when_all(fanOut(slow_backend, size)).get(); }, 20));
+        WARN("fail fast" << suffix << " : " << Bench::latencyPercentiles(
+                 [&]() { return when_all(fanOut(slow_backend, size), expected_task::fail_fast{}).get(); }, 20));
+    }
+}
+
+TEST_CASE("Memory and time of when_all over 256 bytes values", "[!benchmark][when_all]")
+{
+    for(const std::size_t size : {10, 1000, 100000})
+    {
+        const auto suffix = " (" + std::to_string(size) + " tasks)";
+        const auto fromLvalue = [size]()
+        {
+            const auto tasks = largeFanOut(size);
+            return when_all(tasks).get()->size();
+        };
+        const auto fromRvalue = [size]() { return when_all(largeFanOut(size)).get()->size(); };
+        const auto intoBuffer = [size]()
+        {
+            std::vector<std::string> output(size);
+            return when_all(largeFanOut(size), std::span{output}).get()->size();
+        };
+
+        WARN("copying the tasks of an lvalue" << suffix << " : peak of " << Bench::peakBytesDuring(fromLvalue) / 1024
+                                              << " KiB, " << Bench::latencyPercentiles(fromLvalue, 5));
+        WARN("moving the tasks of an rvalue" << suffix << " : peak of " << Bench::peakBytesDuring(fromRvalue) / 1024
+                                             << " KiB, " << Bench::latencyPercentiles(fromRvalue, 5));
+        WARN("moving into the buffer of the caller" << suffix << " : peak of "
+                                                    << Bench::peakBytesDuring(intoBuffer) / 1024 << " KiB, "
+                                                    << Bench::latencyPercentiles(intoBuffer, 5));
+    }
+}
+
+TEST_CASE("Time of when_all when every member fails", "[!benchmark][when_all]")
+{
+    for(const std::size_t size : {100, 1000, 10000})
+    {
+        const auto allFailing = [size]()
+        {
+            std::vector<Task> tasks;
+            tasks.reserve(size);
+            for(std::size_t i = 0; i < size; ++i)
+                tasks.push_back(Task{tl::make_unexpected(std::wstring{L"error"})});
+            return tasks;
+        };
+        const auto suffix = " (" + std::to_string(size) + " failing tasks)";
+        WARN("stacking the errors" << suffix << " : "
+                                   << Bench::latencyPercentiles([&]() { return when_all(allFailing()).get(); }, 5));
+        WARN("collecting the errors" << suffix << " : " << Bench::latencyPercentiles(
+                 [&]() { return when_all(allFailing(), expected_task::collect_errors{}).get(); }, 5));
+        WARN("keeping the first error" << suffix << " : " << Bench::latencyPercentiles(
+                 [&]() { return when_all(allFailing(), expected_task::first_error{}).get(); }, 5));
+    }
+}
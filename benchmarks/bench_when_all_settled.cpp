@@ -0,0 +1,70 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/when_all_settled.hpp>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+
+/**
+ * @brief a batch of ready tasks, one in ten failing.
+ */
+std::vector<Task> batch(const std::size_t size)
+{
+    std::vector<Task> tasks;
+    tasks.reserve(size);
+    for(std::size_t i = 0; i < size; ++i)
+        tasks.push_back(i % 10 == 0 ? Task{tl::make_unexpected(std::wstring{L"error"})} : Task{static_cast<int>(i)});
+    return tasks;
+}
+
+/**
+ * @brief bytes still allocated once the results of the batch are there.
+ */
+template <class FCT> std::size_t bytesKept(FCT&& settle, const std::size_t size)
+{
+    const auto before = Bench::liveBytes();
+    auto tasks = batch(size);
+    const auto results = settle(std::move(tasks));
+    return Bench::liveBytes() - before;
+}
+
+/**
+ * @brief peak of the bytes allocated while settling the batch.
+ */
+template <class FCT> std::size_t peakBytes(FCT&& settle, const std::size_t size)
+{
+    auto tasks = batch(size);
+    return Bench::peakBytesDuring([&settle, &tasks]() { settle(std::move(tasks)); });
+}
+
+} // namespace
+
+TEST_CASE("Memory of the results of when_all_settled", "[!benchmark][when_all_settled]")
+{
+    for(const std::size_t size : {1000, 100000})
+    {
+        const auto suffix = " (" + std::to_string(size) + " tasks, one in ten failing)";
+        const auto asVector = [](std::vector<Task> tasks)
+        {
+            std::vector<Task::task_type> backend_tasks;
+            backend_tasks.reserve(tasks.size());
+            for(auto& task : tasks)
+                backend_tasks.push_back(std::move(task).to_task());
+            return expected_task::backend::when_all(begin(backend_tasks), end(backend_tasks), {}).get();
+        };
+        const auto settled = [](std::vector<Task> tasks) { return when_all_settled(std::move(tasks)).get(); };
+
+        WARN("vector of tl::expected" << suffix << " : peak of " << peakBytes(asVector, size) / 1024 << " KiB, "
+                                      << bytesKept(asVector, size) / 1024 << " KiB of results");
+        WARN("settled_results" << suffix << " : peak of " << peakBytes(settled, size) / 1024 << " KiB, "
+                               << bytesKept(settled, size) / 1024 << " KiB of results");
+    }
+}
@@ -0,0 +1,68 @@
+#include <catch2/catch.hpp>
+
+#include "bench_utilities.hpp"
+
+#include <expected_task/when_any.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+
+/**
+ * @brief replicas answering in 2 ms, 10 ms and 40 ms.
+ */
+struct Replicas
+{
+    Bench::SimulatedBackend fast{2ms};
+    Bench::SimulatedBackend medium{10ms};
+    Bench::SimulatedBackend slow{40ms};
+
+    Task query(Bench::SimulatedBackend& replica, const bool fails)
+    {
+        return Task{replica.answer(fails ? Expected{tl::make_unexpected(std::wstring{L"error"})} : Expected{1})};
+    }
+
+    std::vector<Task> queryAll(const bool fast_fails)
+    {
+        return {query(fast, fast_fails), query(medium, false), query(slow, false)};
+    }
+
+    /**
+     * @brief asks the replicas one after the other, from the fastest, until one succeeds.
+     */
+    Task querySequentially(const bool fast_fails)
+    {
+        return query(fast, fast_fails)
+            .or_else([this](const std::wstring&) { return query(medium, false); })
+            .or_else([this](const std::wstring&) { return query(slow, false); });
+    }
+};
+
+} // namespace
+
+TEST_CASE("Latency of racing replicas with skewed delays", "[!benchmark][when_any]")
+{
+    Replicas replicas;
+
+    for(const bool fast_fails : {false, true})
+    {
+        const std::string suffix = fast_fails ? " (replicas in 2, 10 and 40 ms, the fastest failing)"
+                                              : " (replicas in 2, 10 and 40 ms)";
+        WARN("waiting for all the replicas" << suffix << " : " << Bench::latencyPercentiles(
+                 [&]() { return when_all(replicas.queryAll(fast_fails)).get(); }, 20));
+        WARN("asking the replicas sequentially" << suffix << " : " << Bench::latencyPercentiles(
+                 [&]() { return replicas.querySequentially(fast_fails).get(); }, 20));
+        WARN("when_any" << suffix << " : " << Bench::latencyPercentiles(
+                 [&]() { return when_any(replicas.queryAll(fast_fails)).get(); }, 20));
+        WARN("first_success" << suffix << " : " << Bench::latencyPercentiles(
+                 [&]() { return first_success(replicas.queryAll(fast_fails)).get(); }, 20));
+    }
+}
@@ -0,0 +1,396 @@
+#pragma once
+
+#include "when_all.hpp"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace expected_task
+{
+
+/**
+ * @brief fold_async policy completing with the first error, in the order the tasks finish : the following results
+ * are dropped without being folded.
+ */
+struct stop_on_error
+{
+};
+
+/**
+ * @brief fold_async policy folding the values only, and ignoring the errors.
+ */
+struct skip_errors
+{
+};
+
+namespace details
+{
+
+    /**
+     * @brief hands the backend task of each expected_task of the range over to the state once it is done, and seals
+     * the state once the range has been gone through : ready tasks are handed over right away.
+     */
+    template <class Range, class State>
+    void on_each_completion(Range&& tasks, const std::shared_ptr<State>& state, const pplx::task_options& options)
+    {
+        using task_type = typename std::ranges::range_value_t<Range>::task_type;
+        for(auto it = std::ranges::begin(tasks); it != std::ranges::end(tasks); ++it)
+        {
+            auto taken = take_element<Range>(it);
+            state->add();
+            if(taken.is_ready() && !options.has_scheduler())
+                state->on_done(std::move(taken).to_task());
+            else
+                std::move(taken).to_task().then([state](task_type done) { state->on_done(std::move(done)); },
+                                                backend_options(options));
+        }
+        state->seal();
+    }
+
+    /**
+     * @brief the results of an as_completed, waiting to be taken in the order they finished, and the calls to next
+     * waiting for one.
+     */
+    template <class T, class E> class completion_queue
+    {
+    public:
+        using expected_type = tl::expected<T, E>;
+        using item_type = tl::expected<std::optional<T>, E>;
+
+        explicit completion_queue(pplx::cancellation_token token)
+            : m_token{std::move(token)}
+        {
+        }
+
+        /**
+         * @brief the results nobody asked for are dropped, their exceptions observed.
+         */
+        ~completion_queue()
+        {
+            for(const auto& task : m_ready)
+                observe(task);
+        }
+
+        /**
+         * @brief one more task to wait for : the range isn't done until seal is called.
+         */
+        void add()
+        {
+            m_remaining.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief once the token is cancelled, the results of the tasks finishing are replaced by the cancellation
+         * error.
+         */
+        void on_done(backend::task<expected_type> task)
+        {
+            if(m_token.is_canceled())
+            {
+                observe(task);
+                task = cancelled<backend::task<expected_type>>();
+            }
+            std::unique_lock<std::mutex> lock{m_mutex};
+            if(m_waiters.empty())
+            {
+                m_ready.push_back(std::move(task));
+                lock.unlock();
+            }
+            else
+            {
+                auto waiter = std::move(m_waiters.front());
+                m_waiters.pop_front();
+                lock.unlock();
+                fulfill(waiter, std::move(task));
+            }
+            release();
+        }
+
+        void seal()
+        {
+            release();
+        }
+
+        expected_task<std::optional<T>, E> next()
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            if(!m_ready.empty())
+            {
+                auto task = std::move(m_ready.front());
+                m_ready.pop_front();
+                lock.unlock();
+                try
+                {
+                    return to_item(std::move(task).get());
+                }
+                catch(...)
+                {
+                    return backend::task_from_exception<item_type>(std::current_exception());
+                }
+            }
+            if(m_remaining.load(std::memory_order_acquire) == 0) return item_type{std::nullopt};
+            backend::task_completion_event<item_type> waiter;
+            m_waiters.push_back(waiter);
+            return expected_task<std::optional<T>, E>{backend::create_task(waiter)};
+        }
+
+    private:
+        const pplx::cancellation_token m_token;
+        std::mutex m_mutex;
+        std::deque<backend::task<expected_type>> m_ready;
+        std::deque<backend::task_completion_event<item_type>> m_waiters;
+        // one more while the range is gone through
+        std::atomic<std::size_t> m_remaining{1};
+
+        static item_type to_item(expected_type res)
+        {
+            if(!res) return tl::make_unexpected(std::move(res.error()));
+            return item_type{std::optional<T>{std::move(*res)}};
+        }
+
+        static void fulfill(const backend::task_completion_event<item_type>& waiter, backend::task<expected_type> task)
+        {
+            try
+            {
+                waiter.set(to_item(std::move(task).get()));
+            }
+            catch(...)
+            {
+                waiter.set_exception(std::current_exception());
+            }
+        }
+
+        /**
+         * @brief once all the tasks are done, the calls to next still waiting get the end of the results.
+         */
+        void release()
+        {
+            std::deque<backend::task_completion_event<item_type>> waiters;
+            {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                if(m_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+                waiters.swap(m_waiters);
+            }
+            for(const auto& waiter : waiters)
+                waiter.set(item_type{std::nullopt});
+        }
+    };
+
+    template <class Errors, class E> struct fold_error
+    {
+        using type = aggregated_error_t<Errors, E>;
+    };
+
+    template <class E> struct fold_error<stop_on_error, E>
+    {
+        using type = E;
+    };
+
+    template <class E> struct fold_error<skip_errors, E>
+    {
+        using type = E;
+    };
+
+    template <class Errors, class E> using fold_error_t = typename fold_error<Errors, E>::type;
+
+    /**
+     * @brief the accumulator of a fold_async, into which each value is folded as soon as its task is done.
+     *
+     * The folds are serialized by a lock, so that op needn't be thread safe. Only the errors gathered for an
+     * aggregator grow with the number of tasks.
+     */
+    template <class T, class E, class Acc, class Op, class Errors> class fold_state
+    {
+    public:
+        using expected_type = tl::expected<T, E>;
+        using result_type = tl::expected<Acc, fold_error_t<Errors, E>>;
+
+        fold_state(Acc init, Op op, Errors errors, pplx::cancellation_token token)
+            : m_acc{std::move(init)}
+            , m_op{std::move(op)}
+            , m_errors{std::move(errors)}
+            , m_token{std::move(token)}
+        {
+        }
+
+        backend::task<result_type> result() const
+        {
+            return backend::create_task(m_event);
+        }
+
+        void add()
+        {
+            m_remaining.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void on_done(backend::task<expected_type> task)
+        {
+            outcome_type outcome;
+            {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                if(m_done)
+                    observe(task);
+                else
+                    outcome = fold(std::move(task));
+            }
+            if(outcome) complete(std::move(*outcome));
+            release();
+        }
+
+        void seal()
+        {
+            release();
+        }
+
+    private:
+        using outcome_type = std::optional<std::variant<result_type, std::exception_ptr>>;
+
+        backend::task_completion_event<result_type> m_event;
+        std::mutex m_mutex;
+        Acc m_acc;
+        Op m_op;
+        Errors m_errors;
+        const pplx::cancellation_token m_token;
+        std::vector<E> m_gathered_errors;
+        bool m_done = false;
+        // one more while the range is gone through
+        std::atomic<std::size_t> m_remaining{1};
+
+        /**
+         * @brief folds the result of the task, and returns the outcome of the fold if it ends here : on an error, an
+         * exception, or once the token is cancelled.
+         */
+        outcome_type fold(backend::task<expected_type> task)
+        {
+            if(m_token.is_canceled())
+            {
+                observe(task);
+                return finish(cancelled<result_type>());
+            }
+            try
+            {
+                auto res = std::move(task).get();
+                if(res)
+                    m_acc = m_op(std::move(m_acc), std::move(*res));
+                else if constexpr(std::is_same_v<Errors, stop_on_error>)
+                    return finish(result_type{tl::make_unexpected(std::move(res.error()))});
+                else if constexpr(!std::is_same_v<Errors, skip_errors>)
+                    m_gathered_errors.push_back(std::move(res.error()));
+                return std::nullopt;
+            }
+            catch(...)
+            {
+                return finish(std::current_exception());
+            }
+        }
+
+        template <class Outcome> outcome_type finish(Outcome outcome)
+        {
+            m_done = true;
+            return outcome_type{std::in_place, std::move(outcome)};
+        }
+
+        void complete(std::variant<result_type, std::exception_ptr> outcome)
+        {
+            if(auto* const exception = std::get_if<std::exception_ptr>(&outcome))
+                m_event.set_exception(*exception);
+            else
+                m_event.set(std::move(std::get<result_type>(outcome)));
+        }
+
+        void release()
+        {
+            if(m_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            outcome_type outcome;
+            {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                if(m_done) return;
+                if constexpr(std::is_same_v<Errors, stop_on_error> || std::is_same_v<Errors, skip_errors>)
+                    outcome = finish(result_type{std::move(m_acc)});
+                else if(m_gathered_errors.empty())
+                    outcome = finish(result_type{std::move(m_acc)});
+                else
+                    outcome = finish(result_type{tl::make_unexpected(m_errors(std::move(m_gathered_errors)))});
+            }
+            complete(std::move(*outcome));
+        }
+    };
+
+} // namespace details
+
+/**
+ * @brief the results of a range of expected_tasks, in the order they finish.
+ *
+ * Each call to next gives the following result : its value, or its error, and an empty optional once all of them
+ * have been given. A result is only kept until it is taken, and then released.
+ */
+template <class T, class E> class completion_stream
+{
+public:
+    explicit completion_stream(std::shared_ptr<details::completion_queue<T, E>> queue)
+        : m_queue{std::move(queue)}
+    {
+    }
+
+    expected_task<std::optional<T>, E> next()
+    {
+        return m_queue->next();
+    }
+
+private:
+    std::shared_ptr<details::completion_queue<T, E>> m_queue;
+};
+
+/**
+ * @brief streams the results of the tasks in the order they finish, instead of waiting for all of them.
+ *
+ * Takes any range of expected_tasks, as when_all. The results are taken on the scheduler given in the options, if
+ * any. Once the cancellation token of the options is cancelled, the results still to come are the cancellation_error
+ * of E.
+ */
+template <expected_task_range Range>
+auto as_completed(Range&& tasks, const pplx::task_options& options = {})
+    -> completion_stream<details::range_value_type_t<Range>, details::range_error_type_t<Range>>
+{
+    using queue_type
+        = details::completion_queue<details::range_value_type_t<Range>, details::range_error_type_t<Range>>;
+    const auto queue = std::make_shared<queue_type>(options.get_cancellation_token());
+    details::on_each_completion(std::forward<Range>(tasks), queue, options);
+    return completion_stream{queue};
+}
+
+/**
+ * @brief folds the value of each task into the accumulator as soon as it is done, with op(acc, value) : the results
+ * are released once folded, instead of being gathered first.
+ *
+ * The errors are handled by the policy : stop_on_error, skip_errors, or an aggregator as taken by when_all, turning
+ * all the errors into one once every task is done. An exception, thrown by a task or by op, is forwarded right away.
+ * The resulting task runs on the scheduler given in the options, if any, as do the folds. Once the cancellation token
+ * of the options is cancelled, the next task to finish completes the fold with the cancellation_error of its error.
+ */
+template <expected_task_range Range, class Acc, class Op, class Errors = stop_on_error>
+requires std::is_invocable_r_v<Acc, Op&, Acc, details::range_value_type_t<Range>>
+    && (std::is_same_v<Errors, stop_on_error> || std::is_same_v<Errors, skip_errors>
+        || error_aggregator<Errors, details::range_error_type_t<Range>>)
+auto fold_async(Range&& tasks, Acc init, Op op, Errors errors = {}, const pplx::task_options& options = {})
+    -> expected_task<Acc, details::fold_error_t<Errors, details::range_error_type_t<Range>>>
+{
+    using T = details::range_value_type_t<Range>;
+    using E = details::range_error_type_t<Range>;
+    using state_type = details::fold_state<T, E, Acc, Op, Errors>;
+    const auto state = std::make_shared<state_type>(std::move(init), std::move(op), std::move(errors),
+                                                    options.get_cancellation_token());
+    details::on_each_completion(std::forward<Range>(tasks), state, options);
+    expected_task<Acc, details::fold_error_t<Errors, E>> result{state->result()};
+    if(options.has_scheduler()) return std::move(result).schedule_on(options);
+    return result;
+}
+
+} // namespace expected_task
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "expected_task.hpp"
+#include "timer_wheel.hpp"
+
+#include <chrono>
+#include <memory>
+#include <utility>
+
+namespace expected_task
+{
+
+namespace details
+{
+
+    /**
+     * @brief the shared state of a combinator running as a state machine : the event completing its result, and the
+     * options its continuations run with.
+     */
+    template <class Derived, class Result> class async_state : public std::enable_shared_from_this<Derived>
+    {
+    public:
+        using result_type = Result;
+
+        explicit async_state(const pplx::task_options& options)
+            : m_options{options}
+        {
+        }
+
+        backend::task<Result> result() const
+        {
+            return backend::create_task(m_event);
+        }
+
+    protected:
+        backend::task_completion_event<Result> m_event;
+        const pplx::task_options m_options;
+
+        /**
+         * @brief calls callback with the state once delay has passed. It is called from a task, so that the code of
+         * the user doesn't run on the thread of the wheel.
+         */
+        template <class Callback>
+        timer_id schedule_after(timer_wheel& wheel, const std::chrono::steady_clock::duration delay, Callback callback)
+        {
+            return wheel.schedule_after(delay,
+                                        [self = this->shared_from_this(), callback = std::move(callback),
+                                         options = backend_options(m_options)]()
+                                        { backend::create_task([self, callback]() { callback(*self); }, options); });
+        }
+    };
+
+    /**
+     * @brief the result of a state machine, started by start : on the scheduler of the options, if any.
+     */
+    template <class ResultTask, class State, class Start>
+    ResultTask start_state(const std::shared_ptr<State>& state, const pplx::task_options& options, Start start)
+    {
+        ResultTask result{state->result()};
+        start(*state);
+        if(options.has_scheduler()) return std::move(result).schedule_on(options);
+        return result;
+    }
+
+} // namespace details
+
+} // namespace expected_task
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "expected_task.hpp"
+#include "timer_wheel.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace expected_task
+{
+
+/**
+ * @brief when a batch_loader calls its batch function : once max_batch_size keys are waiting, or max_delay after the
+ * first of them.
+ */
+struct batch_options
+{
+    std::size_t max_batch_size = 100;
+    std::chrono::steady_clock::duration max_delay = std::chrono::milliseconds{1};
+};
+
+/**
+ * @brief coalesces the loads of single keys into calls to a batch function, for backends with a cheaper batch API.
+ *
+ * The batch function takes the keys of a batch, and returns an expected_task of their results, one per key and in
+ * the same order : each one is handed to the load of its key, and an error of the whole batch to all of them. A batch
+ * is sent from the load filling it up, or from a task started by a timer of the wheel once its delay has passed : the
+ * loader has no thread of its own. The batch function should only start the request, without waiting for it.
+ *
+ * Destroying the loader sends the keys still waiting. Once the cancellation token of the options is cancelled, the
+ * loads of the batches finishing complete with the cancellation_error of E.
+ */
+template <class K, class V, class E = std::wstring> class batch_loader
+{
+public:
+    using expected_type = tl::expected<V, E>;
+    using batch_result_type = expected_task<std::vector<expected_type>, E>;
+    using batch_function = std::function<batch_result_type(std::vector<K>)>;
+
+    explicit batch_loader(batch_function fct, const batch_options& batching = {},
+                          const pplx::task_options& options = {}, timer_wheel& wheel = timer_wheel::shared())
+        : m_state{std::make_shared<state>(std::move(fct), batching, options, wheel)}
+    {
+    }
+
+    batch_loader(const batch_loader&) = delete;
+    batch_loader& operator=(const batch_loader&) = delete;
+
+    ~batch_loader()
+    {
+        m_state->flush();
+    }
+
+    /**
+     * @brief the result of the key, once the batch it joins is done.
+     */
+    expected_task<V, E> load(K key)
+    {
+        return m_state->load(std::move(key));
+    }
+
+    /**
+     * @brief sends the keys waiting right away, without waiting for the batch to be full or for its delay.
+     */
+    void flush()
+    {
+        m_state->flush();
+    }
+
+private:
+    struct batch
+    {
+        std::vector<K> keys;
+        std::vector<backend::task_completion_event<expected_type>> events;
+    };
+
+    /**
+     * @brief shared with the timer of the batch waiting, which may expire once the loader is gone.
+     */
+    struct state : std::enable_shared_from_this<state>
+    {
+        batch_function fct;
+        const batch_options batching;
+        const pplx::task_options options;
+        timer_wheel& wheel;
+        std::mutex mutex;
+        batch pending;
+        // the timer of the pending batch, told apart from the ones already sent by their number
+        std::optional<timer_id> timer;
+        std::uint64_t nb_sent = 0;
+
+        state(batch_function function, const batch_options& batch_opts, const pplx::task_options& task_opts,
+              timer_wheel& w)
+            : fct{std::move(function)}
+            , batching{batch_opts}
+            , options{task_opts}
+            , wheel{w}
+        {
+        }
+
+        expected_task<V, E> load(K key)
+        {
+            backend::task_completion_event<expected_type> event;
+            std::optional<batch> full;
+            std::optional<timer_id> armed;
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                if(pending.keys.empty()) timer = arm(nb_sent);
+                pending.keys.push_back(std::move(key));
+                pending.events.push_back(event);
+                if(pending.keys.size() >= batching.max_batch_size) full = take(armed);
+            }
+            if(armed) wheel.cancel(*armed);
+            if(full) send(std::move(*full));
+            expected_task<V, E> result{backend::create_task(event)};
+            if(options.has_scheduler()) return std::move(result).schedule_on(options);
+            return result;
+        }
+
+        void flush()
+        {
+            std::optional<timer_id> armed;
+            std::unique_lock<std::mutex> lock{mutex};
+            auto taken = take(armed);
+            lock.unlock();
+            if(armed) wheel.cancel(*armed);
+            if(!taken.keys.empty()) send(std::move(taken));
+        }
+
+        /**
+         * @brief the batch is sent from a task, so that the batch function doesn't run on the thread of the wheel.
+         */
+        timer_id arm(const std::uint64_t number)
+        {
+            return wheel.schedule_after(batching.max_delay,
+                                        [weak = std::weak_ptr<state>{this->shared_from_this()}, number]()
+                                        {
+                                            if(const auto self = weak.lock())
+                                                backend::create_task([self, number]() { self->expire(number); },
+                                                                     details::backend_options(self->options));
+                                        });
+        }
+
+        /**
+         * @brief sends the batch whose delay has passed, unless it was already sent.
+         */
+        void expire(const std::uint64_t number)
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            if(number != nb_sent) return;
+            std::optional<timer_id> armed;
+            auto taken = take(armed);
+            lock.unlock();
+            if(!taken.keys.empty()) send(std::move(taken));
+        }
+
+        /**
+         * @brief takes the pending batch, and its timer to cancel once the lock is released.
+         */
+        batch take(std::optional<timer_id>& armed)
+        {
+            if(pending.keys.empty()) return {};
+            ++nb_sent;
+            armed = std::exchange(timer, std::nullopt);
+            return std::exchange(pending, {});
+        }
+
+        void send(batch sent)
+        {
+            const auto events = std::make_shared<std::vector<backend::task_completion_event<expected_type>>>(
+                std::move(sent.events));
+            try
+            {
+                fct(std::move(sent.keys))
+                    .to_task()
+                    .then([events, token = options.get_cancellation_token()](
+                              backend::task<tl::expected<std::vector<expected_type>, E>> task)
+                          {
+                              if(!token.is_canceled()) return fan_out(*events, std::move(task));
+                              for(const auto& event : *events)
+                                  event.set(details::cancelled<expected_type>());
+                          },
+                          details::backend_options(options));
+            }
+            catch(...)
+            {
+                for(const auto& event : *events)
+                    event.set_exception(std::current_exception());
+            }
+        }
+    };
+
+    std::shared_ptr<state> m_state;
+
+    /**
+     * @brief hands each result of the batch to the load of its key.
+     */
+    static void fan_out(const std::vector<backend::task_completion_event<expected_type>>& events,
+                        backend::task<tl::expected<std::vector<expected_type>, E>> task)
+    {
+        try
+        {
+            auto results = std::move(task).get();
+            if(!results)
+            {
+                for(const auto& event : events)
+                    event.set(expected_type{tl::make_unexpected(results.error())});
+                return;
+            }
+            if(results->size() != events.size())
+                throw std::length_error{"the batch function must give one result per key"};
+            for(std::size_t i = 0; i < events.size(); ++i)
+                events[i].set(std::move((*results)[i]));
+        }
+        catch(...)
+        {
+            for(const auto& event : events)
+                event.set_exception(std::current_exception());
+        }
+    }
+};
+
+} // namespace expected_task
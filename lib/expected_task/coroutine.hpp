@@ -0,0 +1,224 @@
+#pragma once
+
+#include "expected_task.hpp"
+
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+
+#define EXPECTED_TASK_HAS_COROUTINES 1
+
+namespace expected_task
+{
+
+namespace details
+{
+
+    /**
+     * @brief awaits a task of either backend and resumes the coroutine with its result, or rethrows its exception.
+     */
+    template <class Task> class task_awaiter
+    {
+    public:
+        using T = typename Task::result_type;
+
+        explicit task_awaiter(Task task)
+            : m_task{std::move(task)}
+        {
+        }
+
+        bool await_ready() const
+        {
+            return m_task.is_done();
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            // the continuation can resume and destroy the frame holding m_task before then() returns
+            auto task = m_task;
+            std::move(task).then([handle](Task) { handle.resume(); });
+        }
+
+        T await_resume()
+        {
+            return std::move(m_task).get();
+        }
+
+    private:
+        Task m_task;
+    };
+
+    template <class T, class E> class expected_task_promise;
+
+    /**
+     * @brief awaits an expected_task from inside another expected_task coroutine : resumes the coroutine with the
+     * value, or completes the coroutine with the error without resuming it.
+     */
+    template <class T, class E> class short_circuit_awaiter
+    {
+    public:
+        using expected_type = tl::expected<T, E>;
+
+        explicit short_circuit_awaiter(backend::task<expected_type> task)
+            : m_task{std::move(task)}
+        {
+        }
+
+        bool await_ready() const
+        {
+            return false;
+        }
+
+        template <class Promise> bool await_suspend(std::coroutine_handle<Promise> handle)
+        {
+            if(m_task.is_done()) return !accept(std::move(m_task), handle);
+            // the continuation can resume and destroy the frame holding m_task before then() returns
+            auto pending = std::move(m_task);
+            std::move(pending).then(
+                [this, handle](backend::task<expected_type> task)
+                {
+                    if(accept(std::move(task), handle)) handle.resume();
+                });
+            return true;
+        }
+
+        T await_resume()
+        {
+            if(m_exception) std::rethrow_exception(m_exception);
+            if constexpr(!std::is_same_v<T, void>) return std::move(**m_result);
+        }
+
+    private:
+        backend::task<expected_type> m_task;
+        std::optional<expected_type> m_result;
+        std::exception_ptr m_exception;
+
+        /**
+         * @brief stores the result of the task, and returns true if the coroutine must be resumed.
+         *
+         * On error, the coroutine is completed with the error and destroyed.
+         */
+        template <class Promise>
+        bool accept(backend::task<expected_type> task, std::coroutine_handle<Promise> handle)
+        {
+            try
+            {
+                m_result.emplace(std::move(task).get());
+            }
+            catch(...)
+            {
+                m_exception = std::current_exception();
+                return true;
+            }
+            if(m_result->has_value()) return true;
+            handle.promise().set_result(tl::make_unexpected(std::move(m_result->error())));
+            handle.destroy();
+            return false;
+        }
+    };
+
+    template <class T, class E> class expected_task_promise_base
+    {
+    public:
+        using expected_type = tl::expected<T, E>;
+
+        expected_task<T, E> get_return_object()
+        {
+            return expected_task<T, E>{backend::create_task(m_event)};
+        }
+
+        std::suspend_never initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        void unhandled_exception()
+        {
+            m_event.set_exception(std::current_exception());
+        }
+
+        void set_result(expected_type result)
+        {
+            m_event.set(std::move(result));
+        }
+
+        template <class Val, class Err>
+        requires std::is_convertible_v<Err, E>
+        short_circuit_awaiter<Val, Err> await_transform(const expected_task<Val, Err>& et)
+        {
+            return short_circuit_awaiter<Val, Err>{et.to_task()};
+        }
+
+        template <class Task>
+        requires is_task_v<Task> task_awaiter<Task> await_transform(const Task& task)
+        {
+            return task_awaiter<Task>{task};
+        }
+
+        template <class Awaitable>
+        requires(!is_task_v<std::remove_cvref_t<Awaitable>> && !is_expected_task_v<std::remove_cvref_t<Awaitable>>)
+        Awaitable&& await_transform(Awaitable&& awaitable)
+        {
+            return std::forward<Awaitable>(awaitable);
+        }
+
+    private:
+        backend::task_completion_event<expected_type> m_event;
+    };
+
+    template <class T, class E> class expected_task_promise : public expected_task_promise_base<T, E>
+    {
+    public:
+        using expected_type = tl::expected<T, E>;
+
+        template <class Value>
+        requires std::is_constructible_v<expected_type, Value>
+        void return_value(Value&& value)
+        {
+            this->set_result(expected_type{std::forward<Value>(value)});
+        }
+    };
+
+    template <class E> class expected_task_promise<void, E> : public expected_task_promise_base<void, E>
+    {
+    public:
+        void return_void()
+        {
+            this->set_result({});
+        }
+    };
+
+} // namespace details
+
+/**
+ * @brief awaiting an expected_task from any coroutine other than an expected_task one gives the whole tl::expected.
+ *
+ * Inside a coroutine returning an expected_task, `co_await` gives the value and completes the coroutine with the
+ * error on failure. Await `et.to_task()` to get the tl::expected instead.
+ */
+template <class T, class E> auto operator co_await(const expected_task<T, E>& et)
+{
+    return details::task_awaiter<typename expected_task<T, E>::task_type>{et.to_task()};
+}
+
+} // namespace expected_task
+
+/**
+ * @brief allows coroutines to return an expected_task.
+ *
+ * The coroutine starts eagerly, and can `co_return` a value, a tl::expected or a tl::unexpected. A coroutine
+ * returning an expected_task<void, E> can only fail by awaiting a failing expected_task.
+ */
+template <class T, class E, class... Args> struct std::coroutine_traits<expected_task::expected_task<T, E>, Args...>
+{
+    using promise_type = expected_task::details::expected_task_promise<T, E>;
+};
+
+#endif
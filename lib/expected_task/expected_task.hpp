@@ -1,16 +1,69 @@
 #pragma once
 
+#include <atomic>
 #include <concepts>
+#include <optional>
+#include <string>
+#include <utility>
 
 #include <pplx/pplxtasks.h>
 
 #include <tl/expected.hpp>
 
+#ifdef EXPECTED_TASK_NATIVE_BACKEND
+#include "native_task.hpp"
+#endif
+
 namespace expected_task
 {
 
+namespace native
+{
+    template <class T> class task;
+} // namespace native
+
+/**
+ * @brief the task library running expected_task : pplx, or the native engine when EXPECTED_TASK_NATIVE_BACKEND is
+ * defined. Both accept the pplx::task_options and schedulers, and callbacks can return either kind of task.
+ */
+#ifdef EXPECTED_TASK_NATIVE_BACKEND
+namespace backend = native;
+
+namespace native::details
+{
+    template <class T, class E>
+    struct is_copyable<tl::expected<T, E>> : std::conjunction<is_copyable<T>, is_copyable<E>>
+    {
+    };
+} // namespace native::details
+#else
+namespace backend = pplx;
+#endif
+
 template <class T, class E> class expected_task;
 
+/**
+ * @brief the error a chain finishes with once its cancellation token is cancelled : specialize it for your own error
+ * types. Defaults to a value-initialized error, or to L"cancelled" for std::wstring.
+ */
+template <class E> struct cancellation_error
+{
+    static E make()
+    {
+        return E{};
+    }
+};
+
+template <> struct cancellation_error<std::wstring>
+{
+    static std::wstring make()
+    {
+        return L"cancelled";
+    }
+};
+
+template <class SourceValue, class SourceError, class Stages> class pipeline;
+
 namespace details
 {
 
@@ -22,6 +75,10 @@ namespace details
     {
     };
 
+    template <class T> struct is_task<native::task<T>> : std::true_type
+    {
+    };
+
     template <class T> constexpr bool is_task_v = is_task<T>::value;
 
     template <class T> struct is_expected_task : std::false_type
@@ -44,9 +101,155 @@ namespace details
 
     template <class T> constexpr bool is_expected_v = is_expected<T>::value;
 
+    /**
+     * @brief carries an error through success-only stages as an exception : both backends cancel the value-based
+     * continuations of a faulted task inline, so these stages are never scheduled.
+     */
+    template <class E> class short_circuited_error
+    {
+    public:
+        explicit short_circuited_error(E error)
+            : m_error{make_storage(std::move(error))}
+        {
+        }
+
+        /**
+         * @brief returns a copy of the error, or moves it out if it can't be copied : a move-only error has a
+         * single consumer.
+         */
+        E take() const
+        {
+            if constexpr(std::is_copy_constructible_v<E>)
+                return m_error;
+            else
+                return std::move(*m_error);
+        }
+
+    private:
+        // exceptions must be copyable
+        using storage_type = std::conditional_t<std::is_copy_constructible_v<E>, E, std::shared_ptr<E>>;
+
+        storage_type m_error;
+
+        static storage_type make_storage(E error)
+        {
+            if constexpr(std::is_copy_constructible_v<E>)
+                return error;
+            else
+                return std::make_shared<E>(std::move(error));
+        }
+    };
+
+    /**
+     * @brief turns an error returned by a success-only stage into a short_circuited_error.
+     */
+    template <class E, class Result> Result short_circuit(Result result)
+    {
+        if constexpr(is_expected_v<Result>)
+        {
+            if(!result) throw short_circuited_error<E>{std::move(result.error())};
+        }
+        return result;
+    }
+
+    /**
+     * @brief returns the result of a task, turning a short-circuited error back into an unexpected.
+     *
+     * Given an rvalue, the native backend moves the result out if no other task refers to it.
+     */
+    template <class Task> typename std::remove_cvref_t<Task>::result_type get_result(Task&& task)
+    {
+        using error_type = typename std::remove_cvref_t<Task>::result_type::error_type;
+        try
+        {
+            return std::forward<Task>(task).get();
+        }
+        catch(const short_circuited_error<error_type>& e)
+        {
+            return tl::make_unexpected(e.take());
+        }
+    }
+
+    /**
+     * @brief a flag raised from the const methods of any thread, and copied along with its owner.
+     */
+    class relaxed_flag
+    {
+    public:
+        relaxed_flag() = default;
+
+        relaxed_flag(const relaxed_flag& other)
+            : m_raised{other.is_raised()}
+        {
+        }
+
+        relaxed_flag& operator=(const relaxed_flag& other)
+        {
+            m_raised.store(other.is_raised(), std::memory_order_relaxed);
+            return *this;
+        }
+
+        void raise() const
+        {
+            m_raised.store(true, std::memory_order_relaxed);
+        }
+
+        bool is_raised() const
+        {
+            return m_raised.load(std::memory_order_relaxed);
+        }
+
+    private:
+        mutable std::atomic<bool> m_raised{false};
+    };
+
+    /**
+     * @brief marks the exception of a finished task whose result is dropped as observed : pplx reports the exceptions
+     * of the tasks destroyed without anyone getting them. The native engine doesn't.
+     */
+    template <class Task> void observe(const Task& task)
+    {
+#ifndef EXPECTED_TASK_NATIVE_BACKEND
+        try
+        {
+            task.wait();
+        }
+        catch(...)
+        {
+        }
+#else
+        static_cast<void>(task);
+#endif
+    }
+
+    /**
+     * @brief marks the short-circuited error of a dropped chain as observed, once the chain is done : it is an error
+     * of the chain rather than an exception. Any other exception is handed to a task dropped in turn, so that pplx
+     * still reports it.
+     */
+    template <class E, class Task> void observe_short_circuit(const Task& task)
+    {
+#ifndef EXPECTED_TASK_NATIVE_BACKEND
+        if(!task.is_done()) return void(task.then([](Task done) { observe_short_circuit<E>(done); }));
+        try
+        {
+            task.wait();
+        }
+        catch(const short_circuited_error<E>&)
+        {
+        }
+        catch(...)
+        {
+            backend::task_from_exception<typename Task::result_type>(std::current_exception());
+        }
+#else
+        static_cast<void>(task);
+#endif
+    }
+
     template <class CallbackType, class ArgType> struct callback_return_type
     {
-        using type = decltype(std::declval<CallbackType>()(ArgType{}));
+        using type = decltype(std::declval<CallbackType>()(std::declval<ArgType>()));
     };
 
     template <class CallbackType> struct callback_return_type<CallbackType, void>
@@ -54,21 +257,84 @@ namespace details
         using type = decltype(std::declval<CallbackType>()());
     };
 
+    /**
+     * @brief the cancellation error, as the result of a skipped stage : a tl::expected, or a task of one.
+     */
+    template <class Result> Result cancelled()
+    {
+        if constexpr(is_task_v<Result>)
+            return backend::task_from_result(cancelled<typename Result::result_type>());
+        else
+            return tl::make_unexpected(cancellation_error<typename Result::error_type>::make());
+    }
+
+    /**
+     * @brief the options of a stage, as given to the backend : the stage checks the cancellation token itself, so
+     * that it finishes with an error rather than with a cancelled task.
+     */
+    inline pplx::task_options backend_options(const pplx::task_options& options)
+    {
+        if(!options.has_cancellation_token()) return options;
+        if(options.has_scheduler()) return pplx::task_options{options.get_scheduler()};
+        return {};
+    }
+
     template <class CallbackType, class ArgType>
     using callback_return_type_t = typename callback_return_type<CallbackType, ArgType>::type;
 
 } // namespace details
 
+/**
+ * @brief a task of a tl::expected, running on pplx::task or on the native engine (see backend).
+ *
+ * An expected_task built from a value, a tl::expected or a tl::unexpected keeps its result inline, without any task:
+ * continuations on it run immediately on the calling thread, until an asynchronous stage appears. A fully
+ * synchronous chain is thus never scheduled, and doesn't allocate any task.
+ *
+ * Every chaining method takes optional pplx::task_options : their scheduler, if any, runs the stage (even on a ready
+ * result), and the following stages inherit it. So do they inherit their cancellation token, checked by each stage
+ * before running : once it is cancelled, the stages left are skipped, and the chain finishes with the
+ * cancellation_error of its error type. A stage already running isn't interrupted. Both backends honor the token.
+ *
+ * Chaining from an rvalue consumes the expected_task : its result is moved into the callback instead of being copied,
+ * which move-only values and errors require. Asynchronous results are only moved by the native backend, as pplx::task
+ * copies them.
+ */
 template <class ValueType, class ErrorType = std::wstring> class expected_task
 {
 public:
     using expected_type = tl::expected<ValueType, ErrorType>;
-    using task_type = pplx::task<expected_type>;
+    using task_type = backend::task<expected_type>;
     using value_type = ValueType;
     using error_type = ErrorType;
     using unexpected_type = tl::unexpected<ErrorType>;
 
     expected_task() = default;
+    expected_task(const expected_task&) = default;
+    expected_task(expected_task&&) = default;
+
+    /**
+     * @brief the chain replaced is dropped along with other, and observed as such.
+     */
+    expected_task& operator=(expected_task other)
+    {
+        std::swap(m_task, other.m_task);
+        std::swap(m_ready, other.m_ready);
+        std::swap(m_short_circuits, other.m_short_circuits);
+        std::swap(m_continued, other.m_continued);
+        std::swap(m_cancellation, other.m_cancellation);
+        return *this;
+    }
+
+    /**
+     * @brief a chain dropped before its result is taken, and without being continued, still has its short-circuited
+     * error observed, which pplx would otherwise report as an unhandled exception.
+     */
+    ~expected_task()
+    {
+        if(m_short_circuits && !m_continued.is_raised() && m_task != task_type{})
+            details::observe_short_circuit<error_type>(m_task);
+    }
 
     expected_task(task_type task)
         : m_task{std::move(task)}
@@ -82,103 +348,150 @@ public:
     {
     }
 
-    template <class Val>
-    expected_task(pplx::task<Val> task) requires std::is_convertible_v<Val, ValueType>
-        : m_task{task.then([](Val val) { return expected_type{val}; })}
+    template <class Task>
+    requires details::is_task_v<Task> &&(!std::is_void_v<typename Task::result_type>)
+        && std::is_convertible_v<typename Task::result_type, ValueType> expected_task(Task task)
+        : m_task{std::move(task).then([](typename Task::result_type val) { return expected_type{std::move(val)}; })}
+    {
+    }
+
+    template <class Task>
+    requires details::is_task_v<Task> && std::is_void_v<typename Task::result_type> expected_task(Task task)
+        : m_task{std::move(task).then([]() { return expected_type{}; })}
     {
     }
 
-    expected_task(pplx::task<void> task)
-        : m_task{task.then([]() { return expected_type{}; })}
+    /**
+     * @brief adopts a task of the other backend.
+     */
+    template <class Task>
+    requires details::is_task_v<Task> &&(!std::is_same_v<Task, task_type>)
+        && std::is_same_v<typename Task::result_type, expected_type> expected_task(Task task)
+        : m_task{std::move(task)}
     {
     }
 
     template <class NewT, class NewE>
     requires std::is_convertible_v<NewT, ValueType> && std::is_convertible_v<NewE, ErrorType>
     expected_task(tl::expected<NewT, NewE> value)
-        : m_task{pplx::task_from_result(std::move(value))}
+        : m_ready{std::move(value)}
     {
     }
 
     template <class NewE>
     requires std::is_convertible_v<NewE, ErrorType> expected_task(tl::unexpected<NewE> error)
-        : m_task{pplx::task_from_result(expected_type{std::move(error)})}
+        : m_ready{std::move(error)}
     {
     }
 
     template <class NewT>
     requires std::is_convertible_v<NewT, ValueType> expected_task(NewT&& value)
-        : m_task{pplx::task_from_result(expected_type{std::forward<NewT>(value)})}
+        : m_ready{std::in_place, std::forward<NewT>(value)}
     {
     }
 
     template <class FCT>
     requires(std::is_same_v<value_type, void>&& std::invocable<FCT>)
-        || std::invocable<FCT, value_type> auto then_map(FCT&& callback) const
+        || std::invocable<FCT, value_type> auto then_map(FCT&& callback, const pplx::task_options& options = {}) const&
+    {
+        return continued().then_map(std::forward<FCT>(callback), options);
+    }
+
+    template <class FCT>
+    requires(std::is_same_v<value_type, void>&& std::invocable<FCT>)
+        || std::invocable<FCT, value_type> auto then_map(FCT&& callback, const pplx::task_options& options = {}) &&
     {
         using result_type = details::callback_return_type_t<FCT, value_type>;
 
         if constexpr(details::is_task_v<result_type>)
         {
-            return then_map_with_task(std::forward<FCT>(callback));
+            return std::move(*this).then_map_with_task(std::forward<FCT>(callback), options);
         }
         else
         {
-            return then_map_basic(std::forward<FCT>(callback));
+            return std::move(*this).then_map_basic(std::forward<FCT>(callback), options);
         }
     }
 
     template <class FCT>
     requires(std::is_same_v<value_type, void>&& std::invocable<FCT>)
-        || std::invocable<FCT, value_type> auto and_then(FCT&& callback) const
+        || std::invocable<FCT, value_type> auto and_then(FCT&& callback, const pplx::task_options& options = {}) const&
+    {
+        return continued().and_then(std::forward<FCT>(callback), options);
+    }
+
+    template <class FCT>
+    requires(std::is_same_v<value_type, void>&& std::invocable<FCT>)
+        || std::invocable<FCT, value_type> auto and_then(FCT&& callback, const pplx::task_options& options = {}) &&
     {
         using result_type = details::callback_return_type_t<FCT, value_type>;
         if constexpr(details::is_expected_task_v<result_type>)
         {
-            return and_then_with_expectedtask(std::forward<FCT>(callback));
+            return std::move(*this).and_then_with_expectedtask(std::forward<FCT>(callback), options);
         }
         else if constexpr(details::is_task_v<result_type>)
         {
-            return and_then_with_simple_task(std::forward<FCT>(callback));
+            return std::move(*this).and_then_with_simple_task(std::forward<FCT>(callback), options);
+        }
+        else
+        {
+            return std::move(*this).and_then_basic(std::forward<FCT>(callback), options);
+        }
+    }
+
+    template <class FCT>
+    requires std::invocable<FCT, error_type> expected_task or_else(FCT&& callback,
+                                                                    const pplx::task_options& options = {}) const&
+    {
+        return continued().or_else(std::forward<FCT>(callback), options);
+    }
+
+    template <class FCT>
+    requires std::invocable<FCT, error_type> expected_task or_else(FCT&& callback,
+                                                                    const pplx::task_options& options = {}) &&
+    {
+        using callback_result_type = std::invoke_result_t<FCT, error_type>;
+        if constexpr(details::is_task_v<callback_result_type> || details::is_expected_task_v<callback_result_type>)
+        {
+            return std::move(*this).or_else_with_task(std::forward<FCT>(callback), options);
         }
         else
         {
-            return and_then_basic(std::forward<FCT>(callback));
+            return std::move(*this).or_else_basic(std::forward<FCT>(callback), options);
         }
     }
 
     template <class FCT>
-    requires std::invocable<FCT, error_type> expected_task or_else(FCT&& callback)
-    const
+    requires std::invocable<FCT, error_type>
+    auto map_error(FCT&& callback, const pplx::task_options& options = {}) const&
     {
-        return m_task.then([c = std::forward<FCT>(callback)](expected_type res) mutable
-                           { return res.or_else(std::forward<FCT>(c)); });
+        return continued().map_error(std::forward<FCT>(callback), options);
     }
 
     template <class FCT>
     requires std::invocable<FCT, error_type>
-    auto map_error(FCT&& callback) const
+    auto map_error(FCT&& callback, const pplx::task_options& options = {}) &&
     {
-        using callback_result_type = decltype(callback({}));
+        using callback_result_type = std::invoke_result_t<FCT, error_type>;
         if constexpr(details::is_task_v<callback_result_type>)
         {
-            return map_error_with_task(std::forward<FCT>(callback));
+            return std::move(*this).map_error_with_task(std::forward<FCT>(callback), options);
         }
         else
         {
-            return map_error_basic(std::forward<FCT>(callback));
+            return std::move(*this).map_error_basic(std::forward<FCT>(callback), options);
         }
     }
 
     /**
-     * @brief experimental : pplx::task::then without the overhead
-     * TODO test
+     * @brief adds a continuation to the underlying task, as to_task().then(callback) : the callback gets the
+     * expected_type, and the result is a plain task.
      */
     template <class FCT>
     requires std::invocable<FCT, value_type>
     auto then(FCT&& callback) const
     {
-        return m_task.then(std::forward<FCT>(callback));
+        return to_task().then(std::forward<FCT>(callback));
     }
 
     /**
@@ -186,83 +499,324 @@ public:
      *
      * Does not return a value when called on a task with a value_type of void.
      */
-    auto get() const
+    auto get() const&
     {
-        return m_task.get();
+        if(m_ready) return *m_ready;
+        return details::get_result(m_task);
+    }
+
+    auto get() &&
+    {
+        if(m_ready) return std::move(*m_ready);
+        // getting the result observes the short-circuited error
+        m_short_circuits = false;
+        return details::get_result(std::move(m_task));
     }
 
     /**
      * @brief waits for the task to finish, and then returns its status.
      */
-    auto wait() const
+    pplx::task_status wait() const
+    {
+        if(m_ready) return pplx::completed;
+        try
+        {
+            return m_task.wait();
+        }
+        catch(const details::short_circuited_error<error_type>&)
+        {
+            return pplx::completed;
+        }
+    }
+
+    /**
+     * @brief moves the chain onto the scheduler given in the options : the following stages inherit it, unless they
+     * are given another one.
+     */
+    expected_task schedule_on(const pplx::task_options& options) const&
     {
-        return m_task.wait();
+        return continued().schedule_on(options);
+    }
+
+    expected_task schedule_on(const pplx::task_options& options) &&
+    {
+        return std::move(*this).template continue_with_result<expected_task>([](expected_type res) { return res; },
+                                                                             options);
     }
 
     /**
-     * @brief experimental : gives access to the underlying task
-     * TODO test
+     * @brief the following stages check the token before running, unless they are given their own in their options.
      */
-    task_type to_task() const
+    expected_task with_cancellation(pplx::cancellation_token token) const&
+    {
+        return expected_task{*this}.with_cancellation(std::move(token));
+    }
+
+    expected_task with_cancellation(pplx::cancellation_token token) &&
     {
-        return m_task;
+        m_cancellation = std::move(token);
+        return std::move(*this);
+    }
+
+    /**
+     * @brief returns true if the result is already known, in which case continuations run inline.
+     */
+    bool is_ready() const
+    {
+        return m_ready.has_value();
+    }
+
+    /**
+     * @brief the underlying task. The errors short-circuited past the success-only stages are turned back into
+     * unexpected values : the task never faults with them.
+     */
+    task_type to_task() const&
+    {
+        return continued().to_task();
+    }
+
+    task_type to_task() &&
+    {
+        if(m_ready) return backend::task_from_result(std::move(*m_ready));
+        if(m_short_circuits)
+            return std::move(m_task).then([](task_type task) { return details::get_result(std::move(task)); });
+        return std::move(m_task);
     }
 
     /**
      * @brief returns either the value if there is one, or the mapped error otherwise.
      **/
-    template <class FCT> pplx::task<value_type> then_return_value_or_convert_error_to_value(FCT&& callback)
+    template <class FCT>
+    backend::task<value_type> then_return_value_or_convert_error_to_value(FCT&& callback,
+                                                                          const pplx::task_options& options = {}) const&
+    {
+        return continued().then_return_value_or_convert_error_to_value(std::forward<FCT>(callback), options);
+    }
+
+    template <class FCT>
+    backend::task<value_type> then_return_value_or_convert_error_to_value(FCT&& callback,
+                                                                          const pplx::task_options& options = {}) &&
     {
         using fct_return_type = decltype(std::invoke(std::declval<FCT>(), std::declval<error_type>()));
         if constexpr(details::is_task_v<fct_return_type>)
         {
-            return then_return_value_or_convert_error_to_value_with_task(std::forward<FCT>(callback));
+            return std::move(*this).then_return_value_or_convert_error_to_value_with_task(std::forward<FCT>(callback),
+                                                                                          options);
         }
         else
         {
-            return then_return_value_or_convert_error_to_value_basic(std::forward<FCT>(callback));
+            return std::move(*this).then_return_value_or_convert_error_to_value_basic(std::forward<FCT>(callback),
+                                                                                      options);
         }
     }
 
 private:
+    template <class, class> friend class expected_task;
+    template <class, class, class> friend class pipeline;
+
     task_type m_task;
+    std::optional<expected_type> m_ready;
+    // true when m_task can be faulted by a short_circuited_error, which to_task() must turn back into an unexpected
+    bool m_short_circuits = false;
+    // raised once a copy of the chain is continued : the continuation observes the short-circuited error instead
+    details::relaxed_flag m_continued;
+    pplx::cancellation_token m_cancellation = pplx::cancellation_token::none();
+
+    /**
+     * @brief runs the continuation of a stage that only acts on a value : inline if the result is already known, or
+     * as a continuation of the task otherwise.
+     *
+     * The continuation takes an expected_type and returns either a tl::expected or a task of one. Exceptions thrown
+     * inline end up in the returned task, as they would asynchronously. The continuation is never called with an
+     * error : asynchronously, errors are short-circuited and the following success-only stages are skipped without
+     * being scheduled.
+     *
+     * Like all the stage helpers, it consumes the expected_task : the result is moved into the continuation.
+     */
+    template <class ReturnType, class FCT>
+    ReturnType continue_with(FCT&& continuation, const pplx::task_options& options) &&
+    {
+        const auto token = cancellation_of(options);
+        if(m_ready && !*m_ready)
+            return checking(ReturnType{tl::make_unexpected(std::move(m_ready->error()))}, token);
+        if(runs_inline(options))
+            return checking(std::move(*this).template run_inline<ReturnType>(continuation, token), token);
+        ReturnType result{std::move(*this).antecedent().then(
+            [c = std::forward<FCT>(continuation), token](expected_type res) mutable
+            {
+                if(token.is_canceled()) res = details::cancelled<expected_type>();
+                if(!res) throw details::short_circuited_error<error_type>{std::move(res.error())};
+                return details::short_circuit<error_type>(c(std::move(res)));
+            },
+            details::backend_options(options))};
+        result.m_short_circuits = true;
+        return checking(std::move(result), token);
+    }
+
+    /**
+     * @brief same as continue_with, for the continuations of stages handling errors, which also get the
+     * short-circuited ones.
+     */
+    template <class ReturnType, class FCT>
+    ReturnType continue_with_result(FCT&& continuation, const pplx::task_options& options) &&
+    {
+        using result_type = std::invoke_result_t<FCT&, expected_type>;
+        const auto token = cancellation_of(options);
+        if(runs_inline(options))
+            return checking(std::move(*this).template run_inline<ReturnType>(continuation, token), token);
+        ReturnType result{std::move(*this).antecedent().then(
+            [c = std::forward<FCT>(continuation), token](task_type task) mutable -> result_type
+            {
+                if(token.is_canceled()) return details::cancelled<result_type>();
+                return c(details::get_result(std::move(task)));
+            },
+            details::backend_options(options))};
+        return checking(std::move(result), token);
+    }
+
+    /**
+     * @brief same as continue_with_result, for continuations returning a value_type or a task of one.
+     */
+    template <class FCT>
+    backend::task<value_type> continue_with_value(FCT&& continuation, const pplx::task_options& options) &&
+    {
+        const auto token = cancellation_of(options);
+        if(!runs_inline(options))
+            return std::move(*this).antecedent().then(
+                [c = std::forward<FCT>(continuation), token](task_type task) mutable
+                {
+                    if(token.is_canceled()) return c(details::cancelled<expected_type>());
+                    return c(details::get_result(std::move(task)));
+                },
+                details::backend_options(options));
+        if(token.is_canceled()) m_ready = details::cancelled<expected_type>();
+        try
+        {
+            if constexpr(details::is_task_v<decltype(continuation(std::move(*m_ready)))>)
+                return continuation(std::move(*m_ready));
+            else if constexpr(std::is_same_v<value_type, void>)
+            {
+                continuation(std::move(*m_ready));
+                return backend::task_from_result();
+            }
+            else
+                return backend::task_from_result<value_type>(continuation(std::move(*m_ready)));
+        }
+        catch(...)
+        {
+            return backend::task_from_exception<value_type>(std::current_exception());
+        }
+    }
+
+    /**
+     * @brief continuations run inline on a ready result, unless the caller asked for a specific scheduler.
+     */
+    bool runs_inline(const pplx::task_options& options) const
+    {
+        return m_ready && !options.has_scheduler();
+    }
+
+    /**
+     * @brief the cancellation token checked by a stage : the one of its options, or else the one of the chain.
+     */
+    pplx::cancellation_token cancellation_of(const pplx::task_options& options) const
+    {
+        return options.has_cancellation_token() ? options.get_cancellation_token() : m_cancellation;
+    }
+
+    /**
+     * @brief the following stages inherit the cancellation token of the stage.
+     */
+    template <class ReturnType>
+    static ReturnType checking(ReturnType result, const pplx::cancellation_token& token)
+    {
+        result.m_cancellation = token;
+        return result;
+    }
 
-    template <class FCT> auto then_map_basic(FCT&& callback) const
+    /**
+     * @brief a copy of the chain, to be continued by the const overloads of the stages.
+     */
+    expected_task continued() const
+    {
+        m_continued.raise();
+        return *this;
+    }
+
+    task_type antecedent() &&
+    {
+        if(m_ready) return backend::task_from_result(std::move(*m_ready));
+        return std::move(m_task);
+    }
+
+    template <class ReturnType, class FCT>
+    ReturnType run_inline(FCT& continuation, const pplx::cancellation_token& token) &&
+    {
+        if(token.is_canceled()) return ReturnType{details::cancelled<typename ReturnType::expected_type>()};
+        try
+        {
+            return ReturnType{continuation(std::move(*m_ready))};
+        }
+        catch(...)
+        {
+            return ReturnType{
+                backend::task_from_exception<typename ReturnType::expected_type>(std::current_exception())};
+        }
+    }
+
+    template <class FCT> auto then_map_basic(FCT&& callback, const pplx::task_options& options) &&
     {
         using result_type = details::callback_return_type_t<FCT, value_type>;
 
         static_assert(details::is_task_v<result_type> == false,
                       "use then_map_basic only with functions NOT returning a pplx::task");
         static_assert(details::is_expected_v<result_type> == false, "use and_then with functions returning expected");
-        return expected_task<result_type, error_type>{m_task.then(
-            [c = std::forward<FCT>(callback)](expected_type res) mutable { return res.map(std::forward<FCT>(c)); })};
+        return std::move(*this).template continue_with<expected_task<result_type, error_type>>(
+            [c = std::forward<FCT>(callback)](expected_type res) mutable
+            { return std::move(res).map(std::forward<FCT>(c)); },
+            options);
     }
 
-    template <class FCT> auto then_map_with_task(FCT&& callback) const
+    template <class FCT> auto then_map_with_task(FCT&& callback, const pplx::task_options& options) &&
     {
         using result_type = details::callback_return_type_t<FCT, value_type>;
         static_assert(details::is_task_v<result_type>,
                       "use then_map_with_task only with functions returning a pplx::task");
         using final_type = typename result_type::result_type;
         static_assert(details::is_expected_v<final_type> == false, "use and_then with functions returning expected");
-        return expected_task<final_type, error_type>{
-            m_task.then([c = std::forward<FCT>(callback)](expected_type res) mutable
-                        { return res.map(std::forward<FCT>(c)).map([](auto t) { return t.get(); }); })};
+        using return_type = expected_task<final_type, error_type>;
+        // returning a task from the continuation lets the backend unwrap it, so no worker waits on the inner task
+        return std::move(*this).template continue_with<return_type>(
+            [c = std::forward<FCT>(callback)](expected_type res) mutable -> typename return_type::task_type
+            {
+                if(res)
+                {
+                    if constexpr(std::is_same_v<value_type, void>)
+                        return return_type{c()}.to_task();
+                    else
+                        return return_type{c(std::move(*res))}.to_task();
+                }
+                else
+                    return backend::task_from_result(
+                        typename return_type::expected_type{tl::make_unexpected(std::move(res.error()))});
+            },
+            options);
     }
 
-    template <class FCT> auto and_then_basic(FCT&& callback) const
+    template <class FCT> auto and_then_basic(FCT&& callback, const pplx::task_options& options) &&
     {
         using result_type = details::callback_return_type_t<FCT, value_type>;
         static_assert(details::is_task_v<result_type> == false && details::is_expected_task_v<result_type> == false,
                       "use and_then_basic only with functions NOT returning any kind of task");
         static_assert(details::is_expected_v<result_type>, "use then_map with functions not returning expected");
         static_assert(std::is_convertible_v<typename result_type::error_type, error_type>, "error types must match");
-        return expected_task<typename result_type::value_type, error_type>{
-            m_task.then([c = std::forward<FCT>(callback)](expected_type res) mutable
-                        { return res.and_then(std::forward<FCT>(c)); })};
+        return std::move(*this).template continue_with<expected_task<typename result_type::value_type, error_type>>(
+            [c = std::forward<FCT>(callback)](expected_type res) mutable
+            { return std::move(res).and_then(std::forward<FCT>(c)); },
+            options);
     }
 
-    template <class FCT> auto and_then_with_simple_task(FCT&& callback) const
+    template <class FCT> auto and_then_with_simple_task(FCT&& callback, const pplx::task_options& options) &&
     {
         using result_type = details::callback_return_type_t<FCT, value_type>;
         static_assert(details::is_task_v<result_type>,
@@ -271,66 +825,128 @@ private:
         static_assert(details::is_expected_v<expected_res_type>, "use then_map with functions not returning expected");
         static_assert(std::is_convertible_v<typename expected_res_type::error_type, error_type>,
                       "error types must match");
-        const auto t = m_task.then(
-            [c = std::forward<FCT>(callback)](expected_type res) mutable -> expected_res_type
+        using return_type = expected_task<typename expected_res_type::value_type, error_type>;
+        return std::move(*this).template continue_with<return_type>(
+            [c = std::forward<FCT>(callback)](expected_type res) mutable -> backend::task<expected_res_type>
             {
                 if(res)
                 {
                     if constexpr(std::is_same_v<value_type, void>)
-                        return c().get();
+                        return c();
                     else
-                        return c(std::move(*res)).get();
+                        return c(std::move(*res));
                 }
                 else
-                    return tl::make_unexpected(res.error());
-            });
-        return expected_task<typename expected_res_type::value_type, error_type>(t);
+                    return backend::task_from_result(expected_res_type{tl::make_unexpected(std::move(res.error()))});
+            },
+            options);
     }
 
-    template <class FCT> auto and_then_with_expectedtask(FCT&& callback) const
+    template <class FCT> auto and_then_with_expectedtask(FCT&& callback, const pplx::task_options& options) &&
     {
         using result_type = details::callback_return_type_t<FCT, value_type>;
         static_assert(details::is_expected_task_v<result_type>,
                       "use and_then_with_expectedtask only with functions returning an expected_task");
         static_assert(std::is_convertible_v<typename result_type::error_type, error_type>, "error types must match");
-        const auto t = m_task.then(
-            [c = std::forward<FCT>(callback)](expected_type res) mutable -> typename result_type::expected_type
+        return std::move(*this).template continue_with<expected_task<typename result_type::value_type, error_type>>(
+            [c = std::forward<FCT>(callback)](expected_type res) mutable -> typename result_type::task_type
             {
                 if(res)
                 {
                     if constexpr(std::is_same_v<value_type, void>)
-                        return c().get();
+                        return c().to_task();
                     else
-                        return c(std::move(*res)).get();
+                        return c(std::move(*res)).to_task();
                 }
                 else
-                    return tl::make_unexpected(res.error());
-            });
-        return expected_task<typename result_type::value_type, error_type>(t);
+                    return backend::task_from_result(
+                        typename result_type::expected_type{tl::make_unexpected(std::move(res.error()))});
+            },
+            options);
     }
 
-    template <class FCT> auto map_error_basic(FCT&& callback) const
+    template <class FCT> auto map_error_basic(FCT&& callback, const pplx::task_options& options) &&
     {
-        using callback_result_type = decltype(callback({}));
+        using callback_result_type = std::invoke_result_t<FCT, error_type>;
         static_assert(details::is_task_v<callback_result_type> == false,
                       "use map_error_basic only with functions NOT returning a pplx::task");
         using return_type = expected_task<value_type, callback_result_type>;
-        return return_type{m_task.then([c = std::forward<FCT>(callback)](expected_type res) mutable
-                                       { return res.map_error(std::forward<FCT>(c)); })};
+        return std::move(*this).template continue_with_result<return_type>(
+            [c = std::forward<FCT>(callback)](expected_type res) mutable
+            { return std::move(res).map_error(std::forward<FCT>(c)); },
+            options);
     }
 
-    template <class FCT> auto map_error_with_task(FCT&& callback) const
+    template <class FCT> auto map_error_with_task(FCT&& callback, const pplx::task_options& options) &&
     {
-        using callback_result_type = decltype(callback({}));
+        using callback_result_type = std::invoke_result_t<FCT, error_type>;
         static_assert(details::is_task_v<callback_result_type>,
                       "use map_error_with_task only with functions returning a pplx::task");
-        using return_type = expected_task<value_type, typename callback_result_type::result_type>;
-        return return_type{
-            m_task.then([c = std::forward<FCT>(callback)](expected_type res) mutable
-                        { return res.map_error(std::forward<FCT>(c)).map_error([](auto t) { return t.get(); }); })};
+        using new_error_type = typename callback_result_type::result_type;
+        using return_type = expected_task<value_type, new_error_type>;
+        using return_expected_type = typename return_type::expected_type;
+        return std::move(*this).template continue_with_result<return_type>(
+            [c = std::forward<FCT>(callback)](expected_type res) mutable -> typename return_type::task_type
+            {
+                if(res)
+                {
+                    if constexpr(std::is_same_v<value_type, void>)
+                        return backend::task_from_result(return_expected_type{});
+                    else
+                        return backend::task_from_result(return_expected_type{std::move(*res)});
+                }
+                else
+                    return backend::task<new_error_type>{c(std::move(res.error()))}.then(
+                        [](new_error_type error) -> return_expected_type { return tl::make_unexpected(std::move(error)); });
+            },
+            options);
+    }
+
+    template <class FCT> expected_task or_else_basic(FCT&& callback, const pplx::task_options& options) &&
+    {
+        return std::move(*this).template continue_with_result<expected_task>(
+            [c = std::forward<FCT>(callback)](expected_type res) mutable
+            { return std::move(res).or_else(std::forward<FCT>(c)); },
+            options);
     }
 
-    template <class FCT> pplx::task<value_type> then_return_value_or_convert_error_to_value_basic(FCT&& callback)
+    template <class FCT> expected_task or_else_with_task(FCT&& callback, const pplx::task_options& options) &&
+    {
+        using callback_result_type = std::invoke_result_t<FCT, error_type>;
+        if constexpr(details::is_expected_task_v<callback_result_type>)
+        {
+            static_assert(std::is_same_v<typename callback_result_type::expected_type, expected_type>,
+                          "or_else with a function returning an expected_task must keep the same types");
+        }
+        else
+        {
+            static_assert(std::is_same_v<typename callback_result_type::result_type, expected_type>
+                              || std::is_same_v<typename callback_result_type::result_type, void>,
+                          "or_else with a function returning a pplx::task must return either a "
+                          "pplx::task<tl::expected<T, E>> or a pplx::task<void>");
+        }
+        return std::move(*this).template continue_with_result<expected_task>(
+            [c = std::forward<FCT>(callback)](expected_type res) mutable -> task_type
+            {
+                if(res) return backend::task_from_result(std::move(res));
+                if constexpr(details::is_expected_task_v<callback_result_type>)
+                    return c(std::move(res.error())).to_task();
+                else if constexpr(std::is_same_v<typename callback_result_type::result_type, void>)
+                {
+                    // same semantic as tl::expected::or_else : the error is kept once the callback is done
+                    auto error = res.error();
+                    return backend::task<void>{c(std::move(error))}.then([res = std::move(res)]() mutable
+                                                                         { return std::move(res); });
+                }
+                else
+                    return c(std::move(res.error()));
+            },
+            options);
+    }
+
+    template <class FCT>
+    backend::task<value_type> then_return_value_or_convert_error_to_value_basic(FCT&& callback,
+                                                                                const pplx::task_options& options) &&
     {
         using fct_return_type = decltype(std::invoke(std::declval<FCT>(), std::declval<error_type>()));
         static_assert(details::is_task_v<fct_return_type> == false,
@@ -338,17 +954,20 @@ private:
         static_assert(std::is_convertible_v<fct_return_type, value_type>,
                       "the function passed to then_return_value_or_convert_error_to_value must return a "
                       "value convertible into a T");
-        return m_task.then(
+        return std::move(*this).continue_with_value(
             [c = std::forward<FCT>(callback)](expected_type exp) -> value_type
             {
                 if(exp)
-                    return exp.value();
+                    return std::move(*exp);
                 else
                     return c(std::move(exp.error()));
-            });
+            },
+            options);
     }
 
-    template <class FCT> pplx::task<value_type> then_return_value_or_convert_error_to_value_with_task(FCT&& callback)
+    template <class FCT>
+    backend::task<value_type>
+    then_return_value_or_convert_error_to_value_with_task(FCT&& callback, const pplx::task_options& options) &&
     {
         using fct_return_type = decltype(std::invoke(std::declval<FCT>(), std::declval<error_type>()));
         static_assert(details::is_task_v<fct_return_type>,
@@ -357,21 +976,48 @@ private:
         static_assert(std::is_convertible_v<final_return_type, value_type>,
                       "the function passed to then_return_value_or_convert_error_to_value must return a "
                       "value convertible into a T");
-        return m_task.then(
-            [c = std::forward<FCT>(callback)](expected_type exp) -> value_type
+        return std::move(*this).continue_with_value(
+            [c = std::forward<FCT>(callback)](expected_type exp) -> backend::task<value_type>
             {
                 if(exp)
-                    return exp.value();
+                    return backend::task_from_result(std::move(*exp));
+                else if constexpr(std::is_same_v<final_return_type, value_type>)
+                    return c(std::move(exp.error()));
                 else
-                    return c(std::move(exp.error())).get();
-            });
+                    return backend::task<final_return_type>{c(std::move(exp.error()))}.then(
+                        [](final_return_type value) -> value_type { return value; });
+            },
+            options);
     }
 };
 
-template <class E = std::wstring, class FCT> auto create_task(FCT&& fct)
+/**
+ * @brief runs fct asynchronously, on the scheduler given in the options if any.
+ *
+ * The following stages inherit the scheduler and the cancellation token, unless they are given their own. If the
+ * token is cancelled before fct starts, fct is skipped, and the task finishes with the cancellation_error of E.
+ */
+template <class E = std::wstring, class FCT> auto create_task(FCT&& fct, const pplx::task_options& options = {})
 {
     using ReturnType = decltype(fct());
-    return expected_task<ReturnType, E>{pplx::create_task(std::forward<FCT>(fct))};
+    using result_type = expected_task<ReturnType, E>;
+    if(!options.has_cancellation_token())
+        return result_type{backend::create_task(std::forward<FCT>(fct), options)};
+    auto token = options.get_cancellation_token();
+    result_type result{backend::create_task(
+        [f = std::forward<FCT>(fct), token]() mutable -> typename result_type::expected_type
+        {
+            if(token.is_canceled()) return details::cancelled<typename result_type::expected_type>();
+            if constexpr(std::is_void_v<ReturnType>)
+            {
+                f();
+                return {};
+            }
+            else
+                return f();
+        },
+        details::backend_options(options))};
+    return std::move(result).with_cancellation(std::move(token));
 }
 
 } // namespace expected_task
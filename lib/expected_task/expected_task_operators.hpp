@@ -1,6 +1,7 @@
 #pragma once
 
 #include <concepts>
+#include <utility>
 
 #include <expected_task/expected_task.hpp>
 
@@ -8,7 +9,7 @@ template <class Value, class Error, class Callback>
 requires std::invocable<Callback, Value>
 auto operator>=(expected_task::expected_task<Value, Error>&& et, Callback&& callback)
 {
-    return et.then_map(std::forward<Callback>(callback));
+    return std::move(et).then_map(std::forward<Callback>(callback));
 }
 
 template <class Value, class Error, class Callback>
@@ -29,7 +30,7 @@ template <class Value, class Error, class Callback>
 requires std::invocable<Callback, Value>
 auto operator>>=(expected_task::expected_task<Value, Error>&& exp, Callback&& callback)
 {
-    return exp.and_then(std::forward<Callback>(callback));
+    return std::move(exp).and_then(std::forward<Callback>(callback));
 }
 
 template <class Value, class Error, class Callback>
@@ -50,7 +51,7 @@ template <class Value, class Error, class Callback>
 requires std::invocable<Callback, Error>
 auto operator|=(expected_task::expected_task<Value, Error>&& exp, Callback&& callback)
 {
-    return exp.map_error(std::forward<Callback>(callback));
+    return std::move(exp).map_error(std::forward<Callback>(callback));
 }
 
 template <class Value, class Error, class Callback>
@@ -71,7 +72,7 @@ template <class Value, class Error, class Callback>
 requires std::invocable<Callback, Error>
 auto operator||(expected_task::expected_task<Value, Error>&& exp, Callback&& callback)
 {
-    return exp.or_else(std::forward<Callback>(callback));
+    return std::move(exp).or_else(std::forward<Callback>(callback));
 }
 
 template <class Value, class Error, class Callback>
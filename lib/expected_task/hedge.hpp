@@ -0,0 +1,374 @@
+#pragma once
+
+#include "async_state.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace expected_task
+{
+
+/**
+ * @brief counters of the hedged calls made with a hedge_policy : the calls, the copies sent on top of the first
+ * attempts, and the calls won by one of these copies.
+ */
+struct hedge_statistics
+{
+    std::size_t calls = 0;
+    std::size_t hedges = 0;
+    std::size_t hedge_wins = 0;
+};
+
+/**
+ * @brief when hedge sends another copy of a request : after a fixed delay, or after a percentile of the latencies
+ * observed so far.
+ *
+ * The adaptive policy keeps a histogram of the latencies, with 8 buckets per doubling from 1 us to 16 s : the delay
+ * is within 10 % of the percentile. Once every window samples, the counts are halved, so that the delay follows the
+ * latency of the backend as it changes. The first attempt of a call won by a hedge was still running : the time the
+ * call took is recorded as a lower bound of its latency. As the hedge was sent once the delay had passed, this bound is
+ * above the delay, and counts on the right side of the percentile.
+ *
+ * Copies share the same policy, and statistics : give the same one to the hedged calls to a backend.
+ */
+class hedge_policy
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief a fixed delay.
+     */
+    template <class Rep, class Period>
+    hedge_policy(const std::chrono::duration<Rep, Period> delay)
+        : m_state{std::make_shared<state>(std::chrono::duration_cast<clock::duration>(delay), std::nullopt)}
+    {
+    }
+
+    /**
+     * @brief the percentile of the latencies recorded, once there are min_samples of them, and initial_delay until
+     * then.
+     */
+    static hedge_policy adaptive(const double percentile = 0.95,
+                                 const clock::duration initial_delay = std::chrono::milliseconds{10},
+                                 const std::size_t min_samples = 20, const std::size_t window = 1000)
+    {
+        return hedge_policy{std::make_shared<state>(initial_delay, histogram{percentile, min_samples, window})};
+    }
+
+    /**
+     * @brief the time to wait for an attempt before sending another copy.
+     */
+    clock::duration delay() const
+    {
+        if(!m_state->latencies) return m_state->initial_delay;
+        std::lock_guard<std::mutex> lock{m_state->mutex};
+        return m_state->latencies->percentile().value_or(m_state->initial_delay);
+    }
+
+    /**
+     * @brief adds the latency of a call to the ones the adaptive delay is drawn from.
+     */
+    void record(const clock::duration latency)
+    {
+        if(!m_state->latencies) return;
+        std::lock_guard<std::mutex> lock{m_state->mutex};
+        m_state->latencies->record(latency);
+    }
+
+    hedge_statistics statistics() const
+    {
+        return {m_state->calls.load(std::memory_order_relaxed), m_state->hedges.load(std::memory_order_relaxed),
+                m_state->hedge_wins.load(std::memory_order_relaxed)};
+    }
+
+    void count_call(const bool won_by_hedge)
+    {
+        m_state->calls.fetch_add(1, std::memory_order_relaxed);
+        if(won_by_hedge) m_state->hedge_wins.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void count_hedge()
+    {
+        m_state->hedges.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    class histogram
+    {
+    public:
+        histogram(const double percentile, const std::size_t min_samples, const std::size_t window)
+            : m_percentile{std::clamp(percentile, 0., 1.)}
+            , m_min_samples{min_samples}
+            , m_window{std::max<std::size_t>(window, 1)}
+        {
+            m_counts.fill(0);
+        }
+
+        void record(const clock::duration latency)
+        {
+            const auto us = std::chrono::duration<double, std::micro>(latency).count();
+            const auto bucket = us <= 1. ? 0 : static_cast<std::size_t>(buckets_per_doubling * std::log2(us));
+            ++m_counts[std::min(bucket, nb_buckets - 1)];
+            ++m_total;
+            if(++m_since_halving < m_window) return;
+            m_since_halving = 0;
+            m_total = 0;
+            for(auto& count : m_counts)
+            {
+                count /= 2;
+                m_total += count;
+            }
+        }
+
+        /**
+         * @brief the upper bound of the bucket holding the percentile, if there are enough samples.
+         */
+        std::optional<clock::duration> percentile() const
+        {
+            if(m_total < m_min_samples) return std::nullopt;
+            const auto target = static_cast<std::size_t>(std::ceil(m_percentile * static_cast<double>(m_total)));
+            std::size_t cumulated = 0;
+            std::size_t bucket = 0;
+            for(; bucket + 1 < nb_buckets; ++bucket)
+                if((cumulated += m_counts[bucket]) >= target) break;
+            return std::chrono::duration_cast<clock::duration>(std::chrono::duration<double, std::micro>(
+                std::exp2(static_cast<double>(bucket + 1) / buckets_per_doubling)));
+        }
+
+    private:
+        static constexpr std::size_t buckets_per_doubling = 8;
+        static constexpr std::size_t nb_buckets = 24 * buckets_per_doubling;
+
+        const double m_percentile;
+        const std::size_t m_min_samples;
+        const std::size_t m_window;
+        std::array<std::size_t, nb_buckets> m_counts;
+        // the sum of the counts, which the halving cuts down, unlike the number of samples recorded since
+        std::size_t m_total = 0;
+        std::size_t m_since_halving = 0;
+    };
+
+    struct state
+    {
+        const clock::duration initial_delay;
+        std::mutex mutex;
+        std::optional<histogram> latencies;
+        std::atomic<std::size_t> calls{0};
+        std::atomic<std::size_t> hedges{0};
+        std::atomic<std::size_t> hedge_wins{0};
+
+        state(const clock::duration delay, std::optional<histogram> histo)
+            : initial_delay{delay}
+            , latencies{std::move(histo)}
+        {
+        }
+    };
+
+    explicit hedge_policy(std::shared_ptr<state> s)
+        : m_state{std::move(s)}
+    {
+    }
+
+    std::shared_ptr<state> m_state;
+};
+
+namespace details
+{
+
+    /**
+     * @brief the attempts of a hedged call : the first one to finish wins, and the others are cancelled. So are they
+     * when the token of the options is, and the call then finishes with the cancellation error instead.
+     */
+    template <class Factory, class T, class E>
+    class hedge_state : public async_state<hedge_state<Factory, T, E>, tl::expected<T, E>>
+    {
+    public:
+        using expected_type = tl::expected<T, E>;
+
+        hedge_state(Factory factory, hedge_policy policy, const std::size_t max_hedges,
+                    const pplx::task_options& options, timer_wheel& wheel)
+            : async_state<hedge_state, expected_type>{options}
+            , m_factory{std::move(factory)}
+            , m_policy{std::move(policy)}
+            , m_max_attempts{max_hedges + 1}
+            , m_wheel{wheel}
+            , m_start{clock::now()}
+            , m_token{options.get_cancellation_token()}
+            , m_losers{losers_source(m_token)}
+        {
+        }
+
+        /**
+         * @brief starts the first attempt, and the timer of the next one if it isn't done right away.
+         */
+        void start()
+        {
+            if(m_token.is_canceled()) return cancel();
+            const auto delay = m_policy.delay();
+            if(launch(0) && m_max_attempts > 1) arm(delay);
+        }
+
+    private:
+        using clock = std::chrono::steady_clock;
+        using async_state<hedge_state, expected_type>::m_event;
+        using async_state<hedge_state, expected_type>::m_options;
+
+        Factory m_factory;
+        hedge_policy m_policy;
+        const std::size_t m_max_attempts;
+        timer_wheel& m_wheel;
+        const clock::time_point m_start;
+        const pplx::cancellation_token m_token;
+        pplx::cancellation_token_source m_losers;
+        std::mutex m_mutex;
+        std::size_t m_started = 1;
+        std::optional<timer_id> m_timer;
+        bool m_done = false;
+
+        /**
+         * @brief the source cancelling the attempts which lost, linked to the token of the caller.
+         */
+        static pplx::cancellation_token_source losers_source(pplx::cancellation_token token)
+        {
+            if(!token.is_cancelable()) return {};
+            return pplx::cancellation_token_source::create_linked_source(token);
+        }
+
+        /**
+         * @brief starts an attempt : returns false if it is done right away.
+         */
+        bool launch(const std::size_t index)
+        {
+            std::optional<expected_task<T, E>> task;
+            try
+            {
+                if constexpr(std::is_invocable_v<Factory&, pplx::cancellation_token>)
+                    task.emplace(std::invoke(m_factory, m_losers.get_token()));
+                else
+                    task.emplace(std::invoke(m_factory));
+            }
+            catch(...)
+            {
+                on_done(index, backend::task_from_exception<expected_type>(std::current_exception()));
+                return false;
+            }
+            if(task->is_ready())
+            {
+                on_done(index, std::move(*task).to_task());
+                return false;
+            }
+            std::move(*task).to_task().then([self = this->shared_from_this(), index](backend::task<expected_type> done)
+                                            { self->on_done(index, std::move(done)); },
+                                            backend_options(m_options));
+            return true;
+        }
+
+        void arm(const clock::duration delay)
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if(m_done) return;
+            m_timer = this->schedule_after(m_wheel, delay, [delay](hedge_state& state) { state.hedge(delay); });
+        }
+
+        void hedge(const clock::duration delay)
+        {
+            if(m_token.is_canceled()) return cancel();
+            std::size_t index;
+            {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                if(m_done) return;
+                m_timer.reset();
+                index = m_started++;
+            }
+            m_policy.count_hedge();
+            if(launch(index) && index + 1 < m_max_attempts) arm(delay);
+        }
+
+        void on_done(const std::size_t index, backend::task<expected_type> task)
+        {
+            if(m_token.is_canceled())
+            {
+                observe(task);
+                return cancel();
+            }
+            std::optional<timer_id> timer;
+            {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                if(m_done) return observe(task);
+                m_done = true;
+                timer = std::exchange(m_timer, std::nullopt);
+            }
+            if(timer) m_wheel.cancel(*timer);
+            // a lower bound of the latency of the first attempt if a hedge won, as it was still running
+            m_policy.record(clock::now() - m_start);
+            m_policy.count_call(index > 0);
+            m_losers.cancel();
+            try
+            {
+                m_event.set(std::move(task).get());
+            }
+            catch(...)
+            {
+                m_event.set_exception(std::current_exception());
+            }
+        }
+
+        /**
+         * @brief finishes the call with the cancellation error, unless it is done already.
+         */
+        void cancel()
+        {
+            std::optional<timer_id> timer;
+            {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                if(m_done) return;
+                m_done = true;
+                timer = std::exchange(m_timer, std::nullopt);
+            }
+            if(timer) m_wheel.cancel(*timer);
+            m_losers.cancel();
+            m_event.set(cancelled<expected_type>());
+        }
+    };
+
+} // namespace details
+
+/**
+ * @brief calls the factory, and calls it again each time the policy's delay passes without any of the attempts being
+ * done, up to max_hedges more times. Completes with the result of the first attempt to finish, value, error or
+ * exception alike.
+ *
+ * A factory taking a pplx::cancellation_token gets one cancelled once the call is won : given to the chains of the
+ * attempts with with_cancellation, the losers then skip their stages left. The policy counts the hedges fired, and
+ * learns the latency from the calls if it is adaptive. The delays are timers of the wheel, and the hedges are started
+ * from tasks. Once the cancellation token of the options is cancelled, so is the one given to the factory : no other
+ * hedge is sent, and the call finishes with the cancellation_error of E when the next timer fires or attempt finishes.
+ * The continuations and the resulting task run on the scheduler given in the options, if any.
+ */
+template <class Factory>
+requires(std::is_invocable_v<Factory&, pplx::cancellation_token> || std::is_invocable_v<Factory&>)
+auto hedge(Factory factory, hedge_policy policy, const std::size_t max_hedges = 1,
+           const pplx::task_options& options = {}, timer_wheel& wheel = timer_wheel::shared())
+{
+    using result_type = std::conditional_t<std::is_invocable_v<Factory&, pplx::cancellation_token>,
+                                           std::invoke_result<Factory&, pplx::cancellation_token>,
+                                           std::invoke_result<Factory&>>::type;
+    static_assert(details::is_expected_task_v<result_type>, "the factory must return an expected_task");
+    using state_type
+        = details::hedge_state<Factory, typename result_type::value_type, typename result_type::error_type>;
+    return details::start_state<result_type>(
+        std::make_shared<state_type>(std::move(factory), std::move(policy), max_hedges, options, wheel), options,
+        [](state_type& state) { state.start(); });
+}
+
+} // namespace expected_task
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "async_state.hpp"
+#include "ranges.hpp"
+
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+namespace expected_task
+{
+
+namespace details
+{
+
+    /**
+     * @brief runs the iterations of a loop one after the other.
+     *
+     * The loop tells the next iteration, what to keep of its value, and the final result. Only the state of the loop
+     * and the current iteration are kept, whatever the number of iterations. Iterations ready right away are run in
+     * a loop, and the others resume it from their continuation : the stack doesn't grow either.
+     */
+    template <class Loop> class loop_state : public async_state<loop_state<Loop>, typename Loop::result_type>
+    {
+    public:
+        using task_type = typename Loop::task_type;
+        using iteration_type = typename task_type::expected_type;
+        using result_type = typename Loop::result_type;
+
+        template <class... Args>
+        explicit loop_state(const pplx::task_options& options, Args&&... args)
+            : async_state<loop_state, result_type>{options}
+            , m_loop{std::forward<Args>(args)...}
+            , m_token{options.get_cancellation_token()}
+        {
+        }
+
+        void run()
+        {
+            while(true)
+            {
+                if(m_token.is_canceled()) return void(m_event.set(cancelled<result_type>()));
+                std::optional<task_type> task;
+                try
+                {
+                    task = m_loop.next();
+                    if(!task) return void(m_event.set(m_loop.result()));
+                }
+                catch(...)
+                {
+                    return void(m_event.set_exception(std::current_exception()));
+                }
+                if(!task->is_ready())
+                {
+                    std::move(*task).to_task().then(
+                        [self = this->shared_from_this()](backend::task<iteration_type> done)
+                        { self->on_done(std::move(done)); },
+                        backend_options(m_options));
+                    return;
+                }
+                if(!consume(std::move(*task).get())) return;
+            }
+        }
+
+    private:
+        using async_state<loop_state, result_type>::m_event;
+        using async_state<loop_state, result_type>::m_options;
+
+        Loop m_loop;
+        const pplx::cancellation_token m_token;
+
+        void on_done(backend::task<iteration_type> done)
+        {
+            try
+            {
+                if(!consume(std::move(done).get())) return;
+            }
+            catch(...)
+            {
+                return void(m_event.set_exception(std::current_exception()));
+            }
+            run();
+        }
+
+        /**
+         * @brief keeps the value of the iteration : returns false once the loop stopped on its error.
+         */
+        bool consume(iteration_type res)
+        {
+            if(!res)
+            {
+                m_event.set(result_type{tl::make_unexpected(std::move(res.error()))});
+                return false;
+            }
+            m_loop.consume(std::move(res));
+            return true;
+        }
+    };
+
+    template <class Loop, class... Args> auto run_loop(const pplx::task_options& options, Args&&... args)
+    {
+        using state_type = loop_state<Loop>;
+        using result_type = typename state_type::result_type;
+        return start_state<expected_task<typename result_type::value_type, typename result_type::error_type>>(
+            std::make_shared<state_type>(options, std::forward<Args>(args)...), options,
+            [](state_type& state) { state.run(); });
+    }
+
+    template <class State, class Condition, class Body> class while_loop
+    {
+    public:
+        using task_type = std::invoke_result_t<Body&, State>;
+        using result_type = tl::expected<State, typename task_type::error_type>;
+
+        while_loop(State initial, Condition condition, Body body)
+            : m_state{std::move(initial)}
+            , m_condition{std::move(condition)}
+            , m_body{std::move(body)}
+        {
+        }
+
+        std::optional<task_type> next()
+        {
+            if(!std::invoke(m_condition, std::as_const(m_state))) return std::nullopt;
+            return std::invoke(m_body, std::move(m_state));
+        }
+
+        void consume(typename task_type::expected_type res)
+        {
+            m_state = std::move(*res);
+        }
+
+        result_type result()
+        {
+            return std::move(m_state);
+        }
+
+    private:
+        State m_state;
+        Condition m_condition;
+        Body m_body;
+    };
+
+    template <class Body, class Predicate> class repeat_loop
+    {
+    public:
+        using task_type = std::invoke_result_t<Body&>;
+        using value_type = typename task_type::value_type;
+        using result_type = tl::expected<value_type, typename task_type::error_type>;
+
+        repeat_loop(Body body, Predicate predicate)
+            : m_body{std::move(body)}
+            , m_predicate{std::move(predicate)}
+        {
+        }
+
+        std::optional<task_type> next()
+        {
+            if(m_last && std::invoke(m_predicate, std::as_const(*m_last))) return std::nullopt;
+            return std::invoke(m_body);
+        }
+
+        void consume(typename task_type::expected_type res)
+        {
+            m_last = std::move(*res);
+        }
+
+        result_type result()
+        {
+            return std::move(*m_last);
+        }
+
+    private:
+        Body m_body;
+        Predicate m_predicate;
+        std::optional<value_type> m_last;
+    };
+
+    template <class View, class FCT> class for_each_loop
+    {
+    public:
+        using task_type = std::invoke_result_t<FCT&, std::ranges::range_value_t<View>>;
+        using result_type = tl::expected<void, typename task_type::error_type>;
+
+        for_each_loop(View inputs, FCT fct)
+            : m_inputs{std::move(inputs)}
+            , m_next{std::ranges::begin(m_inputs)}
+            , m_fct{std::move(fct)}
+        {
+        }
+
+        std::optional<task_type> next()
+        {
+            if(m_next == std::ranges::end(m_inputs)) return std::nullopt;
+            auto input = take_element<View>(m_next);
+            ++m_next;
+            return std::invoke(m_fct, std::move(input));
+        }
+
+        void consume(typename task_type::expected_type)
+        {
+        }
+
+        result_type result()
+        {
+            return {};
+        }
+
+    private:
+        View m_inputs;
+        std::ranges::iterator_t<View> m_next;
+        FCT m_fct;
+    };
+
+} // namespace details
+
+/**
+ * @brief runs body as long as condition holds : body takes the state and returns an expected_task of the next one.
+ * Completes with the state for which condition is false, or with the first error.
+ *
+ * Unlike nesting and_then calls, the iterations don't build a chain of tasks : the memory used is the same whatever
+ * their number, and iterations done right away are run in a loop, without growing the stack. Exceptions thrown by
+ * condition, body or its tasks are forwarded. Once the cancellation token of the options is cancelled, no other
+ * iteration is started, and the loop finishes with the cancellation_error of E. The continuations and the resulting
+ * task run on the scheduler given in the options, if any.
+ */
+template <class State, class Condition, class Body>
+requires std::predicate<Condition&, const State&> && details::is_expected_task_v<std::invoke_result_t<Body&, State>>
+auto while_async(State initial, Condition condition, Body body, const pplx::task_options& options = {})
+{
+    static_assert(std::is_same_v<typename std::invoke_result_t<Body&, State>::value_type, State>,
+                  "the body must return an expected_task of the next state");
+    return details::run_loop<details::while_loop<State, Condition, Body>>(options, std::move(initial),
+                                                                          std::move(condition), std::move(body));
+}
+
+/**
+ * @brief runs body until predicate holds for the value of its expected_task, and completes with this value, or with
+ * the first error. Runs in constant memory and stack, as while_async.
+ */
+template <std::invocable Body, class Predicate>
+requires details::is_expected_task_v<std::invoke_result_t<Body&>>
+         && std::predicate<Predicate&, const typename std::invoke_result_t<Body&>::value_type&>
+auto repeat_until(Body body, Predicate predicate, const pplx::task_options& options = {})
+{
+    return details::run_loop<details::repeat_loop<Body, Predicate>>(options, std::move(body), std::move(predicate));
+}
+
+/**
+ * @brief calls fct, returning an expected_task, on the inputs one after the other, each one once the task of the
+ * previous one is done. Completes once all the tasks are done, or with the first error, without going through the
+ * inputs left. The values of the tasks are dropped.
+ *
+ * The inputs are only gone through as the tasks are started, so a lazy range is never materialized. An rvalue range
+ * is kept by the resulting task, and an lvalue range must outlive it. The inputs are moved into fct only out of an
+ * rvalue container or owning_view, as transform_async does. Runs in constant memory and stack, as while_async.
+ */
+template <std::ranges::input_range Range, class FCT>
+requires details::is_expected_task_v<std::invoke_result_t<FCT&, std::ranges::range_value_t<std::views::all_t<Range>>>>
+auto for_each_sequential(Range&& inputs, FCT fct, const pplx::task_options& options = {})
+{
+    return details::run_loop<details::for_each_loop<std::views::all_t<Range>, FCT>>(
+        options, std::views::all(std::forward<Range>(inputs)), std::move(fct));
+}
+
+} // namespace expected_task
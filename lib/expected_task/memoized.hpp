@@ -0,0 +1,262 @@
+#pragma once
+
+#include "expected_task.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace expected_task
+{
+
+/**
+ * @brief how long a memoized keeps the results, and how many of them.
+ *
+ * Errors are kept for error_ttl, usually much shorter than ttl, so that a failing key isn't hammered while it fails.
+ * The capacity is split evenly between the shards, each one evicting its least recently used keys.
+ */
+struct cache_options
+{
+    std::size_t capacity = 10000;
+    std::chrono::steady_clock::duration ttl = std::chrono::minutes{1};
+    std::chrono::steady_clock::duration error_ttl = std::chrono::seconds{1};
+    std::size_t nb_shards = 16;
+};
+
+/**
+ * @brief counters of a memoized : results given from the cache, calls joining a call in flight for the same key, and
+ * calls to the function.
+ */
+struct cache_statistics
+{
+    std::size_t hits = 0;
+    std::size_t joins = 0;
+    std::size_t misses = 0;
+};
+
+/**
+ * @brief wraps a function returning an expected_task, sharing a single call between the concurrent callers of the
+ * same key, and caching its results for a while.
+ *
+ * The keys are spread by hash over shards, each one with its own lock. Beyond its capacity, a shard evicts the expired
+ * results and its least recently used ones, but never a call in flight. A cached result is given back as a ready
+ * expected_task, without any task : V and E must be copyable, as every caller gets a copy. An exception thrown by the
+ * function is forwarded to the callers in flight, and isn't cached.
+ */
+template <class K, class V, class E = std::wstring, class Hash = std::hash<K>> class memoized
+{
+public:
+    using function_type = std::function<expected_task<V, E>(const K&)>;
+
+    explicit memoized(function_type fct, const cache_options& options = {})
+        : m_state{std::make_shared<state>(std::move(fct), options)}
+    {
+    }
+
+    expected_task<V, E> operator()(const K& key)
+    {
+        return m_state->get(key);
+    }
+
+    /**
+     * @brief forgets the result of the key, or the call in flight for it : the next call calls the function again.
+     */
+    void invalidate(const K& key)
+    {
+        m_state->invalidate(key);
+    }
+
+    cache_statistics statistics() const
+    {
+        return {m_state->hits.load(std::memory_order_relaxed), m_state->joins.load(std::memory_order_relaxed),
+                m_state->misses.load(std::memory_order_relaxed)};
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+    using expected_type = tl::expected<V, E>;
+
+    struct entry
+    {
+        expected_task<V, E> result;
+        // only set once the result is known
+        std::optional<clock::time_point> expiry;
+        std::uint64_t generation;
+        typename std::list<K>::iterator recency;
+    };
+
+    struct shard
+    {
+        std::mutex mutex;
+        std::unordered_map<K, entry, Hash> entries;
+        // most recently used first
+        std::list<K> recency;
+    };
+
+    /**
+     * @brief shared with the calls in flight, which may finish once the memoized is gone.
+     */
+    struct state : std::enable_shared_from_this<state>
+    {
+        function_type fct;
+        const cache_options options;
+        const std::size_t shard_capacity;
+        std::vector<shard> shards;
+        std::atomic<std::uint64_t> next_generation{0};
+        std::atomic<std::size_t> hits{0};
+        std::atomic<std::size_t> joins{0};
+        std::atomic<std::size_t> misses{0};
+
+        state(function_type function, const cache_options& opts)
+            : fct{std::move(function)}
+            , options{opts}
+            , shard_capacity{std::max<std::size_t>(opts.capacity / std::max<std::size_t>(opts.nb_shards, 1), 1)}
+            , shards(std::max<std::size_t>(opts.nb_shards, 1))
+        {
+        }
+
+        shard& shard_of(const K& key)
+        {
+            return shards[Hash{}(key) % shards.size()];
+        }
+
+        /**
+         * @brief the cached result or the call in flight : only a miss creates the event of a new call.
+         */
+        expected_task<V, E> get(const K& key)
+        {
+            auto& target = shard_of(key);
+            std::optional<backend::task_completion_event<expected_type>> event;
+            std::optional<expected_task<V, E>> result;
+            std::uint64_t generation;
+            {
+                std::lock_guard<std::mutex> lock{target.mutex};
+                const auto it = target.entries.find(key);
+                if(it != end(target.entries))
+                {
+                    auto& found = it->second;
+                    if(!found.expiry || clock::now() < *found.expiry)
+                    {
+                        (found.expiry ? hits : joins).fetch_add(1, std::memory_order_relaxed);
+                        target.recency.splice(begin(target.recency), target.recency, found.recency);
+                        return found.result;
+                    }
+                    erase(target, it);
+                }
+                misses.fetch_add(1, std::memory_order_relaxed);
+                generation = next_generation.fetch_add(1, std::memory_order_relaxed);
+                event.emplace();
+                result.emplace(backend::create_task(*event));
+                insert(target, key, entry{*result, {}, generation, {}});
+            }
+            call(key, generation, *event);
+            return std::move(*result);
+        }
+
+        void invalidate(const K& key)
+        {
+            auto& target = shard_of(key);
+            std::lock_guard<std::mutex> lock{target.mutex};
+            const auto it = target.entries.find(key);
+            if(it != end(target.entries)) erase(target, it);
+        }
+
+        /**
+         * @brief calls the function, and stores its result once it is known, unless the key was meanwhile evicted.
+         */
+        void call(const K& key, const std::uint64_t generation,
+                  const backend::task_completion_event<expected_type>& event)
+        {
+            try
+            {
+                fct(key).to_task().then(
+                    [self = this->shared_from_this(), key, generation, event](backend::task<expected_type> task)
+                    {
+                        try
+                        {
+                            auto res = std::move(task).get();
+                            self->store(key, generation, res);
+                            event.set(std::move(res));
+                        }
+                        catch(...)
+                        {
+                            self->forget(key, generation);
+                            event.set_exception(std::current_exception());
+                        }
+                    });
+            }
+            catch(...)
+            {
+                forget(key, generation);
+                event.set_exception(std::current_exception());
+            }
+        }
+
+        void store(const K& key, const std::uint64_t generation, const expected_type& res)
+        {
+            auto& target = shard_of(key);
+            std::lock_guard<std::mutex> lock{target.mutex};
+            const auto it = target.entries.find(key);
+            if(it == end(target.entries) || it->second.generation != generation) return;
+            it->second.result = expected_task<V, E>{res};
+            it->second.expiry = clock::now() + (res ? options.ttl : options.error_ttl);
+        }
+
+        void forget(const K& key, const std::uint64_t generation)
+        {
+            auto& target = shard_of(key);
+            std::lock_guard<std::mutex> lock{target.mutex};
+            const auto it = target.entries.find(key);
+            if(it != end(target.entries) && it->second.generation == generation) erase(target, it);
+        }
+
+        void insert(shard& target, const K& key, entry added)
+        {
+            target.recency.push_front(key);
+            added.recency = begin(target.recency);
+            target.entries.insert_or_assign(key, std::move(added));
+            if(target.entries.size() > shard_capacity) evict(target);
+        }
+
+        /**
+         * @brief goes from the least recently used key, dropping the expired results on the way, up to the first
+         * result still valid, dropped as well if the shard is still beyond its capacity. The calls in flight are
+         * skipped, so that their key keeps a single call : the shard only grows beyond its capacity when all its
+         * keys are in flight.
+         */
+        void evict(shard& target)
+        {
+            const auto now = clock::now();
+            for(auto key = target.recency.end(); key != target.recency.begin();)
+            {
+                const auto it = target.entries.find(*--key);
+                if(!it->second.expiry) continue;
+                const bool expired = now >= *it->second.expiry;
+                if(!expired && target.entries.size() <= shard_capacity) return;
+                key = std::next(key);
+                erase(target, it);
+                if(!expired) return;
+            }
+        }
+
+        static void erase(shard& target, typename std::unordered_map<K, entry, Hash>::iterator it)
+        {
+            target.recency.erase(it->second.recency);
+            target.entries.erase(it);
+        }
+    };
+
+    std::shared_ptr<state> m_state;
+};
+
+} // namespace expected_task
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace expected_task::native
+{
+
+namespace details
+{
+
+    /**
+     * @brief small blocks recycled by one thread at a time.
+     *
+     * Blocks are sorted into power of two size classes, each one with its own free list, and carved out of slabs
+     * aligned on their size : the start of a slab records the cache owning it, which any thread can find back from a
+     * block. The owning thread allocates and frees without any synchronisation ; blocks freed by other threads, as
+     * continuations often are, go through a lock-free list per size class that the owner takes back in one exchange
+     * once its own list is empty.
+     *
+     * Slabs are never given back : when its thread exits, the cache is handed to the next thread needing one, so its
+     * memory stays valid for the blocks still in use.
+     */
+    class thread_cache
+    {
+    public:
+        static constexpr std::size_t min_block_size = 16;
+        static constexpr std::size_t max_block_size = 1024;
+        static constexpr std::size_t max_alignment = 64;
+        static constexpr std::size_t slab_size = 64 * 1024;
+
+        thread_cache(const thread_cache&) = delete;
+        thread_cache& operator=(const thread_cache&) = delete;
+
+        static bool is_pooled(const std::size_t bytes, const std::size_t alignment)
+        {
+            return bytes <= max_block_size && alignment <= max_alignment;
+        }
+
+        /**
+         * @brief the cache of the calling thread, taken from the idle ones or created on first use.
+         */
+        static thread_cache& local()
+        {
+            thread_local const owner current;
+            return *current.cache;
+        }
+
+        /**
+         * @brief the cache owning a block it allocated.
+         */
+        static thread_cache& of(void* const block)
+        {
+            const auto slab = std::bit_cast<std::uintptr_t>(block) & ~std::uintptr_t{slab_size - 1};
+            return *std::bit_cast<slab_header*>(slab)->cache;
+        }
+
+        void* allocate(const std::size_t bytes, const std::size_t alignment)
+        {
+            const auto index = class_index(bytes, alignment);
+            auto& sizes = m_classes[index];
+            if(!sizes.free) sizes.free = sizes.remote_free.exchange(nullptr, std::memory_order_acquire);
+            if(sizes.free)
+            {
+                const auto block = sizes.free;
+                sizes.free = block->next;
+                return block;
+            }
+            const auto block_size = min_block_size << index;
+            if(sizes.slab_cursor == sizes.slab_end)
+            {
+                const auto slab
+                    = static_cast<std::byte*>(std::pmr::new_delete_resource()->allocate(slab_size, slab_size));
+                new(slab) slab_header{this};
+                sizes.slab_cursor = slab + std::max(sizeof(slab_header), block_size);
+                sizes.slab_end = slab + slab_size;
+            }
+            const auto block = sizes.slab_cursor;
+            sizes.slab_cursor += block_size;
+            return block;
+        }
+
+        /**
+         * @brief gives a block back to this cache, from any thread.
+         */
+        void deallocate(void* const pointer, const std::size_t bytes, const std::size_t alignment)
+        {
+            auto& sizes = m_classes[class_index(bytes, alignment)];
+            const auto block = static_cast<free_block*>(pointer);
+            if(t_owned == this)
+            {
+                block->next = sizes.free;
+                sizes.free = block;
+                return;
+            }
+            block->next = sizes.remote_free.load(std::memory_order_relaxed);
+            while(!sizes.remote_free.compare_exchange_weak(block->next, block, std::memory_order_release,
+                                                           std::memory_order_relaxed))
+            {
+            }
+        }
+
+    private:
+        struct free_block
+        {
+            free_block* next;
+        };
+
+        struct alignas(max_alignment) slab_header
+        {
+            thread_cache* cache;
+        };
+
+        struct size_class
+        {
+            free_block* free = nullptr;
+            std::atomic<free_block*> remote_free{nullptr};
+            std::byte* slab_cursor = nullptr;
+            std::byte* slab_end = nullptr;
+        };
+
+        static constexpr std::size_t nb_classes = std::bit_width(max_block_size) - std::bit_width(min_block_size) + 1;
+
+        /**
+         * @brief caches whose thread has exited, waiting for a new one.
+         */
+        struct registry
+        {
+            std::mutex mutex;
+            std::vector<thread_cache*> idle;
+        };
+
+        struct owner
+        {
+            thread_cache* cache = acquire();
+
+            owner()
+            {
+                t_owned = cache;
+            }
+
+            ~owner()
+            {
+                t_owned = nullptr;
+                auto& caches = idle_caches();
+                std::lock_guard<std::mutex> lock{caches.mutex};
+                caches.idle.push_back(cache);
+            }
+        };
+
+        static inline thread_local thread_cache* t_owned = nullptr;
+
+        std::array<size_class, nb_classes> m_classes;
+
+        thread_cache() = default;
+
+        static registry& idle_caches()
+        {
+            // never destroyed : threads can exit during static destruction
+            static auto* const caches = new registry;
+            return *caches;
+        }
+
+        static thread_cache* acquire()
+        {
+            auto& caches = idle_caches();
+            std::lock_guard<std::mutex> lock{caches.mutex};
+            if(caches.idle.empty()) return new thread_cache;
+            const auto cache = caches.idle.back();
+            caches.idle.pop_back();
+            return cache;
+        }
+
+        static std::size_t class_index(const std::size_t bytes, const std::size_t alignment)
+        {
+            const auto block_size = std::bit_ceil(std::max({bytes, alignment, min_block_size}));
+            return std::bit_width(block_size) - std::bit_width(min_block_size);
+        }
+    };
+
+    /**
+     * @brief allocates from the cache of the calling thread, and gives blocks back to the cache they come from.
+     *
+     * Bigger or over-aligned blocks come from the upstream new/delete resource.
+     */
+    class thread_local_pool_resource final : public std::pmr::memory_resource
+    {
+    private:
+        void* do_allocate(const std::size_t bytes, const std::size_t alignment) override
+        {
+            if(!thread_cache::is_pooled(bytes, alignment))
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            return thread_cache::local().allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* const pointer, const std::size_t bytes, const std::size_t alignment) override
+        {
+            if(!thread_cache::is_pooled(bytes, alignment))
+                return std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+            thread_cache::of(pointer).deallocate(pointer, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+} // namespace details
+
+/**
+ * @brief memory resource recycling small blocks in a cache per thread, without locks.
+ *
+ * Blocks can be freed by any thread, and stay valid after the thread allocating them exits.
+ */
+inline std::pmr::memory_resource* thread_local_pool()
+{
+    // never destroyed : detached threads can still free blocks during static destruction
+    static auto* const resource = new details::thread_local_pool_resource;
+    return resource;
+}
+
+} // namespace expected_task::native
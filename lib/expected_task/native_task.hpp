@@ -0,0 +1,796 @@
+#pragma once
+
+#include "memory_pool.hpp"
+
+#include <pplx/pplxtasks.h>
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace expected_task::native
+{
+
+template <class T> class task;
+template <class T> class task_completion_event;
+
+template <class Iterator> auto when_all(Iterator first, Iterator last, const pplx::task_options& options = {});
+
+namespace details
+{
+
+    template <class T> struct is_native_task : std::false_type
+    {
+    };
+
+    template <class T> struct is_native_task<task<T>> : std::true_type
+    {
+    };
+
+    template <class T> struct is_pplx_task : std::false_type
+    {
+    };
+
+    template <class T> struct is_pplx_task<pplx::task<T>> : std::true_type
+    {
+    };
+
+    /**
+     * @brief type of the result of a continuation, once a returned task has been unwrapped.
+     */
+    template <class T> struct unwrapped
+    {
+        using type = T;
+    };
+
+    template <class T> struct unwrapped<task<T>>
+    {
+        using type = T;
+    };
+
+    template <class T> struct unwrapped<pplx::task<T>>
+    {
+        using type = T;
+    };
+
+    template <class T> using unwrapped_t = typename unwrapped<T>::type;
+
+    struct unit
+    {
+    };
+
+    template <class T> using storage_t = std::conditional_t<std::is_void_v<T>, unit, T>;
+
+    /**
+     * @brief std::is_copy_constructible, seeing through the containers claiming to be copyable whatever their
+     * elements : specialised for the result types holding values.
+     */
+    template <class T> struct is_copyable : std::is_copy_constructible<T>
+    {
+    };
+
+    template <class T, class Allocator> struct is_copyable<std::vector<T, Allocator>> : is_copyable<T>
+    {
+    };
+
+    template <> struct is_copyable<void> : std::true_type
+    {
+    };
+
+    template <class T> constexpr bool is_copyable_v = is_copyable<T>::value;
+
+    /**
+     * @brief anything notified once its antecedent is done : it receives the last reference the antecedent held.
+     */
+    class continuation_node
+    {
+    public:
+        virtual ~continuation_node() = default;
+        virtual void on_antecedent_done(std::shared_ptr<continuation_node> self) = 0;
+    };
+
+    // continuations notified inline by the completing thread, beyond which they are notified from the scheduler
+    inline thread_local int t_inline_depth = 0;
+    constexpr int max_inline_depth = 64;
+
+    inline thread_local std::pmr::memory_resource* t_memory_resource = nullptr;
+
+    /**
+     * @brief allocates a state and its control block in a single block of the resource.
+     */
+    template <class State, class... Args>
+    std::shared_ptr<State> make_state(std::pmr::memory_resource* resource, Args&&... args)
+    {
+        return std::allocate_shared<State>(std::pmr::polymorphic_allocator<State>{resource}, resource,
+                                           std::forward<Args>(args)...);
+    }
+
+    inline pplx::scheduler_ptr get_scheduler(const pplx::scheduler_ptr& scheduler)
+    {
+        if(scheduler) return scheduler;
+        return pplx::scheduler_ptr{pplx::get_ambient_scheduler()};
+    }
+
+    /**
+     * @brief runs its jobs right away, on the calling thread.
+     */
+    class inline_scheduler : public pplx::scheduler_interface
+    {
+    public:
+        void schedule(pplx::TaskProc_t proc, void* param) override
+        {
+            proc(param);
+        }
+
+        static const std::shared_ptr<inline_scheduler>& instance()
+        {
+            static const auto scheduler = std::make_shared<inline_scheduler>();
+            return scheduler;
+        }
+    };
+
+    inline void notify(std::shared_ptr<continuation_node> node)
+    {
+        if(t_inline_depth < max_inline_depth)
+        {
+            ++t_inline_depth;
+            auto& target = *node;
+            target.on_antecedent_done(std::move(node));
+            --t_inline_depth;
+            return;
+        }
+        // a long chain completing at once would otherwise grow the stack by one notification per task
+        const auto job = new std::shared_ptr<continuation_node>{std::move(node)};
+        get_scheduler({})->schedule(
+            [](void* param)
+            {
+                std::unique_ptr<std::shared_ptr<continuation_node>> pending{
+                    static_cast<std::shared_ptr<continuation_node>*>(param)};
+                auto& target = **pending;
+                target.on_antecedent_done(std::move(*pending));
+            },
+            job);
+    }
+
+    /**
+     * @brief result of a task, and the continuations waiting for it.
+     *
+     * Completion is a single atomic state : pending, then attaching and attached while the first continuation is
+     * stored inline, then done. The first continuation is thus attached and run without any lock or allocation ;
+     * only the following ones go through a spin lock protected list.
+     */
+    template <class T> class shared_state
+    {
+    public:
+        explicit shared_state(std::pmr::memory_resource* resource, pplx::scheduler_ptr scheduler = {})
+            : m_scheduler{std::move(scheduler)}
+            , m_resource{resource}
+        {
+        }
+
+        shared_state(const shared_state&) = delete;
+        shared_state& operator=(const shared_state&) = delete;
+        virtual ~shared_state() = default;
+
+        template <class... Args> void set_value(Args&&... args)
+        {
+            m_value.emplace(std::forward<Args>(args)...);
+            complete();
+        }
+
+        void set_exception(std::exception_ptr exception)
+        {
+            m_exception = std::move(exception);
+            complete();
+        }
+
+        /**
+         * @brief sets the result with the one returned by fct, or with the exception it throws.
+         */
+        template <class FCT> void set_from(FCT&& fct)
+        {
+            try
+            {
+                if constexpr(std::is_void_v<std::invoke_result_t<FCT>>)
+                {
+                    fct();
+                    m_value.emplace();
+                }
+                else
+                    m_value.emplace(fct());
+            }
+            catch(...)
+            {
+                m_exception = std::current_exception();
+            }
+            complete();
+        }
+
+        /**
+         * @brief returns true the first time only : settles the race between several producers.
+         */
+        bool try_claim()
+        {
+            return !m_claimed.test_and_set(std::memory_order_acq_rel);
+        }
+
+        bool is_done() const
+        {
+            return m_state.load(std::memory_order_acquire) == state::done;
+        }
+
+        void wait() const
+        {
+            for(auto current = m_state.load(std::memory_order_acquire); current != state::done;
+                current = m_state.load(std::memory_order_acquire))
+                m_state.wait(current, std::memory_order_acquire);
+        }
+
+        const std::exception_ptr& exception() const
+        {
+            return m_exception;
+        }
+
+        const storage_t<T>& value() const
+        {
+            return *m_value;
+        }
+
+        storage_t<T>& value()
+        {
+            return *m_value;
+        }
+
+        void add_handle()
+        {
+            m_handles.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void remove_handle()
+        {
+            m_handles.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        /**
+         * @brief true when a single task refers to this state : no one else can read the result anymore.
+         *
+         * Continuations waiting on the state count as tasks, but not the references keeping it alive while it runs.
+         */
+        bool has_single_handle() const
+        {
+            return m_handles.load(std::memory_order_acquire) == 1;
+        }
+
+        const pplx::scheduler_ptr& scheduler() const
+        {
+            return m_scheduler;
+        }
+
+        /**
+         * @brief resource this state comes from, which its continuations inherit.
+         */
+        std::pmr::memory_resource* resource() const
+        {
+            return m_resource;
+        }
+
+        void attach(std::shared_ptr<continuation_node> node)
+        {
+            auto current = m_state.load(std::memory_order_acquire);
+            if(current == state::pending
+               && m_state.compare_exchange_strong(current, state::attaching, std::memory_order_acq_rel))
+            {
+                m_continuation = std::move(node);
+                current = state::attaching;
+                if(m_state.compare_exchange_strong(current, state::attached, std::memory_order_acq_rel)) return;
+                // completed while attaching : the completing thread left the continuation to us
+                notify(std::move(m_continuation));
+                return;
+            }
+            if(current != state::done)
+            {
+                lock();
+                if(!is_done())
+                {
+                    if(!m_others) m_others = std::make_unique<std::vector<std::shared_ptr<continuation_node>>>();
+                    m_others->push_back(std::move(node));
+                    unlock();
+                    return;
+                }
+                unlock();
+            }
+            notify(std::move(node));
+        }
+
+    private:
+        enum class state : std::uint32_t
+        {
+            pending,
+            attaching,
+            attached,
+            done
+        };
+
+        std::atomic<state> m_state{state::pending};
+        std::atomic<std::size_t> m_handles{0};
+        std::atomic_flag m_claimed = ATOMIC_FLAG_INIT;
+        std::atomic_flag m_others_lock = ATOMIC_FLAG_INIT;
+        std::optional<storage_t<T>> m_value;
+        std::exception_ptr m_exception;
+        std::shared_ptr<continuation_node> m_continuation;
+        std::unique_ptr<std::vector<std::shared_ptr<continuation_node>>> m_others;
+        pplx::scheduler_ptr m_scheduler;
+        std::pmr::memory_resource* m_resource;
+
+        void complete()
+        {
+            const auto previous = m_state.exchange(state::done, std::memory_order_acq_rel);
+            m_state.notify_all();
+            if(previous == state::pending) return;
+            if(previous == state::attached) notify(std::move(m_continuation));
+            lock();
+            auto others = std::move(m_others);
+            unlock();
+            if(others)
+                for(auto& node : *others)
+                    notify(std::move(node));
+        }
+
+        void lock()
+        {
+            while(m_others_lock.test_and_set(std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+
+        void unlock()
+        {
+            m_others_lock.clear(std::memory_order_release);
+        }
+    };
+
+    enum class continuation_kind
+    {
+        none,
+        value_based,
+        task_based
+    };
+
+    /**
+     * @brief state of a task running fct once its antecedent is done, holding fct inline.
+     *
+     * A value-based continuation of a faulted task gets the exception inline, without being scheduled. A returned
+     * task is unwrapped by attaching this same state to it.
+     */
+    template <class Antecedent, class Result, class FCT, continuation_kind Kind>
+    class then_node final
+        : public shared_state<Result>
+        , public continuation_node
+    {
+    public:
+        then_node(std::pmr::memory_resource* resource, task<Antecedent> antecedent, FCT fct,
+                  pplx::scheduler_ptr scheduler)
+            : shared_state<Result>{resource, std::move(scheduler)}
+            , m_antecedent{std::move(antecedent)}
+            , m_fct{std::move(fct)}
+        {
+        }
+
+        void on_antecedent_done(std::shared_ptr<continuation_node> self) override
+        {
+            if(m_inner.m_state)
+            {
+                auto inner = std::move(m_inner);
+                if(inner.m_state->exception())
+                    this->set_exception(inner.m_state->exception());
+                else
+                    this->set_value(inner.take());
+                return;
+            }
+            if constexpr(Kind == continuation_kind::value_based)
+            {
+                if(m_antecedent.m_state->exception())
+                {
+                    auto exception = m_antecedent.m_state->exception();
+                    m_antecedent = {};
+                    this->set_exception(std::move(exception));
+                    return;
+                }
+            }
+            schedule(std::static_pointer_cast<then_node>(std::move(self)));
+        }
+
+        void schedule(std::shared_ptr<then_node> self)
+        {
+            m_self = std::move(self);
+            get_scheduler(this->scheduler())->schedule(&then_node::run, this);
+        }
+
+    private:
+        task<Antecedent> m_antecedent;
+        FCT m_fct;
+        std::shared_ptr<then_node> m_self;
+        task<Result> m_inner;
+
+        static void run(void* param)
+        {
+            const auto node = static_cast<then_node*>(param);
+            node->execute(std::move(node->m_self));
+        }
+
+        decltype(auto) invoke()
+        {
+            if constexpr(Kind == continuation_kind::task_based)
+                return m_fct(std::move(m_antecedent));
+            else if constexpr(Kind == continuation_kind::none || std::is_void_v<Antecedent>)
+                return m_fct();
+            else
+                return m_fct(m_antecedent.take());
+        }
+
+        void execute(std::shared_ptr<then_node> self)
+        {
+            using fct_result_type = decltype(invoke());
+            if constexpr(is_native_task<fct_result_type>::value || is_pplx_task<fct_result_type>::value)
+            {
+                try
+                {
+                    task<Result> inner{invoke()};
+                    // self goes to the inner task, which can complete and release this state right away
+                    m_antecedent = {};
+                    unwrap(std::move(self), std::move(inner));
+                }
+                catch(...)
+                {
+                    m_antecedent = {};
+                    this->set_exception(std::current_exception());
+                }
+            }
+            else
+            {
+                this->set_from([this]() -> decltype(auto) { return invoke(); });
+                m_antecedent = {};
+            }
+        }
+
+        void unwrap(std::shared_ptr<then_node> self, task<Result> inner)
+        {
+            m_inner = std::move(inner);
+            // attaching can complete this state, and release m_inner with it
+            const auto state = m_inner.m_state;
+            state->attach(std::move(self));
+        }
+    };
+
+    template <class T> class when_all_node final
+        : public shared_state<std::vector<T>>
+        , public continuation_node
+    {
+    public:
+        when_all_node(std::pmr::memory_resource* resource, std::vector<task<T>> inputs, pplx::scheduler_ptr scheduler)
+            : shared_state<std::vector<T>>{resource, std::move(scheduler)}
+            , m_inputs{std::move(inputs)}
+            , m_remaining{m_inputs.size()}
+        {
+        }
+
+        void on_antecedent_done(std::shared_ptr<continuation_node>) override
+        {
+            if(m_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            auto inputs = std::move(m_inputs);
+            for(const auto& input : inputs)
+                if(input.m_state->exception()) return this->set_exception(input.m_state->exception());
+            std::vector<T> results;
+            results.reserve(inputs.size());
+            for(auto& input : inputs)
+                results.push_back(input.take());
+            this->set_value(std::move(results));
+        }
+
+    private:
+        std::vector<task<T>> m_inputs;
+        std::atomic<std::size_t> m_remaining;
+    };
+
+    template <class Antecedent, class FCT> constexpr continuation_kind kind_of()
+    {
+        if constexpr(std::is_void_v<Antecedent>)
+            return std::is_invocable_v<FCT&> ? continuation_kind::value_based : continuation_kind::task_based;
+        else
+            return std::is_invocable_v<FCT&, Antecedent&&> ? continuation_kind::value_based
+                                                             : continuation_kind::task_based;
+    }
+
+    template <class Antecedent, class FCT, continuation_kind Kind> struct continuation_result
+    {
+        using type = std::invoke_result_t<FCT&, task<Antecedent>>;
+    };
+
+    template <class Antecedent, class FCT> struct continuation_result<Antecedent, FCT, continuation_kind::value_based>
+    {
+        using type = std::invoke_result_t<FCT&, Antecedent&&>;
+    };
+
+    template <class FCT> struct continuation_result<void, FCT, continuation_kind::value_based>
+    {
+        using type = std::invoke_result_t<FCT&>;
+    };
+
+    template <class FCT> struct continuation_result<void, FCT, continuation_kind::none>
+    {
+        using type = std::invoke_result_t<FCT&>;
+    };
+
+} // namespace details
+
+/**
+ * @brief memory resource the tasks created by the calling thread are allocated from : new/delete, unless a
+ * scoped_memory_resource is alive on the thread.
+ *
+ * Continuations come from the resource of their antecedent, so a whole chain shares the resource of its first task.
+ */
+inline std::pmr::memory_resource* get_memory_resource()
+{
+    if(details::t_memory_resource) return details::t_memory_resource;
+    return std::pmr::new_delete_resource();
+}
+
+/**
+ * @brief sets the memory resource of the tasks created by the calling thread, for its lifetime.
+ *
+ * The resource must outlive the tasks allocated from it. thread_local_pool() avoids most allocations.
+ */
+class scoped_memory_resource
+{
+public:
+    explicit scoped_memory_resource(std::pmr::memory_resource* resource)
+        : m_previous{std::exchange(details::t_memory_resource, resource)}
+    {
+    }
+
+    scoped_memory_resource(const scoped_memory_resource&) = delete;
+    scoped_memory_resource& operator=(const scoped_memory_resource&) = delete;
+
+    ~scoped_memory_resource()
+    {
+        details::t_memory_resource = m_previous;
+    }
+
+private:
+    std::pmr::memory_resource* m_previous;
+};
+
+/**
+ * @brief lightweight task, with the same interface and semantic as the subset of pplx::task used by expected_task.
+ *
+ * Each stage is a single allocation holding both its result and its continuation, taken from the memory resource
+ * of the chain, and completes through one atomic exchange. Exceptions are only involved when a continuation throws.
+ * Continuations run on the scheduler given in their task_options or inherited from their antecedent, and otherwise
+ * on pplx's ambient scheduler ; cancellation tokens are ignored.
+ *
+ * A pplx::task converts implicitly into a native task : continuations can return either kind of task.
+ */
+template <class T> class task
+{
+public:
+    using result_type = T;
+
+    task() = default;
+
+    explicit task(std::shared_ptr<details::shared_state<T>> state)
+        : m_state{std::move(state)}
+    {
+        if(m_state) m_state->add_handle();
+    }
+
+    task(const task& other)
+        : m_state{other.m_state}
+    {
+        if(m_state) m_state->add_handle();
+    }
+
+    task(task&& other) noexcept
+        : m_state{std::move(other.m_state)}
+    {
+    }
+
+    task& operator=(task other) noexcept
+    {
+        std::swap(m_state, other.m_state);
+        return *this;
+    }
+
+    ~task()
+    {
+        if(m_state) m_state->remove_handle();
+    }
+
+    task(const pplx::task<T>& adopted)
+        : task{details::make_state<details::shared_state<T>>(get_memory_resource())}
+    {
+        // only forwards the result, from the thread completing the pplx::task
+        adopted.then([state = m_state](pplx::task<T> done) { state->set_from([&done]() { return done.get(); }); },
+                     pplx::task_options{details::inline_scheduler::instance()});
+    }
+
+    template <class FCT> auto then(FCT fct, const pplx::task_options& options = {}) const&
+    {
+        return task{*this}.then(std::move(fct), options);
+    }
+
+    /**
+     * @brief same as then, giving this task to the continuation : the last continuation of a task moves its result
+     * instead of copying it.
+     */
+    template <class FCT> auto then(FCT fct, const pplx::task_options& options = {}) &&
+    {
+        constexpr auto kind = details::kind_of<T, FCT>();
+        using fct_result_type = typename details::continuation_result<T, FCT, kind>::type;
+        using result_type = details::unwrapped_t<fct_result_type>;
+        using node_type = details::then_node<T, result_type, FCT, kind>;
+        const auto antecedent = m_state;
+        auto scheduler = options.has_scheduler() ? options.get_scheduler() : antecedent->scheduler();
+        auto node = details::make_state<node_type>(antecedent->resource(), std::move(*this), std::move(fct),
+                                                   std::move(scheduler));
+        const auto state = std::static_pointer_cast<details::shared_state<result_type>>(node);
+        antecedent->attach(std::move(node));
+        return task<result_type>{state};
+    }
+
+    /**
+     * @brief waits for the task, and returns its result or rethrows its exception.
+     */
+    T get() const& requires details::is_copyable_v<details::storage_t<T>>
+    {
+        wait();
+        if constexpr(!std::is_void_v<T>) return m_state->value();
+    }
+
+    /**
+     * @brief same as get, moving the result out when this is the last task referring to it.
+     */
+    T get() &&
+    {
+        wait();
+        if constexpr(!std::is_void_v<T>) return take();
+    }
+
+    /**
+     * @brief waits for the task, rethrowing its exception if it has one.
+     */
+    pplx::task_status wait() const
+    {
+        m_state->wait();
+        if(m_state->exception()) std::rethrow_exception(m_state->exception());
+        return pplx::completed;
+    }
+
+    bool is_done() const
+    {
+        return m_state->is_done();
+    }
+
+    bool operator==(const task& other) const
+    {
+        return m_state == other.m_state;
+    }
+
+private:
+    template <class, class, class, details::continuation_kind> friend class details::then_node;
+    template <class> friend class details::when_all_node;
+    template <class Iterator> friend auto when_all(Iterator first, Iterator last, const pplx::task_options& options);
+
+    std::shared_ptr<details::shared_state<T>> m_state;
+
+    /**
+     * @brief moves the result out if no other task refers to it, or if it can't be copied : a task of a move-only
+     * result has a single consumer. Copies it otherwise.
+     */
+    details::storage_t<T> take()
+    {
+        if constexpr(details::is_copyable_v<details::storage_t<T>>)
+        {
+            if(!m_state->has_single_handle()) return m_state->value();
+        }
+        return std::move(m_state->value());
+    }
+};
+
+/**
+ * @brief sets the result of the tasks created from it : only the first call to set or set_exception has an effect.
+ */
+template <class T> class task_completion_event
+{
+public:
+    template <class... Args> bool set(Args&&... args) const
+    {
+        if(!m_state->try_claim()) return false;
+        m_state->set_value(std::forward<Args>(args)...);
+        return true;
+    }
+
+    bool set_exception(std::exception_ptr exception) const
+    {
+        if(!m_state->try_claim()) return false;
+        m_state->set_exception(std::move(exception));
+        return true;
+    }
+
+private:
+    template <class U> friend task<U> create_task(const task_completion_event<U>& event);
+
+    std::shared_ptr<details::shared_state<T>> m_state
+        = details::make_state<details::shared_state<T>>(get_memory_resource());
+};
+
+template <class T> task<T> create_task(const task_completion_event<T>& event)
+{
+    return task<T>{event.m_state};
+}
+
+/**
+ * @brief runs fct on the scheduler given in the options, or on the ambient one.
+ */
+template <class FCT>
+requires std::invocable<FCT&> auto create_task(FCT fct, const pplx::task_options& options = {})
+{
+    using result_type = details::unwrapped_t<std::invoke_result_t<FCT&>>;
+    using node_type = details::then_node<void, result_type, FCT, details::continuation_kind::none>;
+    auto node = details::make_state<node_type>(get_memory_resource(), task<void>{}, std::move(fct),
+                                               options.get_scheduler());
+    const auto state = std::static_pointer_cast<details::shared_state<result_type>>(node);
+    node->schedule(std::move(node));
+    return task<result_type>{state};
+}
+
+template <class T> task<T> task_from_result(T value)
+{
+    const auto state = details::make_state<details::shared_state<T>>(get_memory_resource());
+    state->set_value(std::move(value));
+    return task<T>{state};
+}
+
+inline task<void> task_from_result()
+{
+    const auto state = details::make_state<details::shared_state<void>>(get_memory_resource());
+    state->set_value();
+    return task<void>{state};
+}
+
+template <class T> task<T> task_from_exception(std::exception_ptr exception)
+{
+    const auto state = details::make_state<details::shared_state<T>>(get_memory_resource());
+    state->set_exception(std::move(exception));
+    return task<T>{state};
+}
+
+/**
+ * @brief completes with the results of all the tasks, in order, or with the exception of the first faulted one.
+ *
+ * The options only give the scheduler inherited by the continuations of the returned task.
+ */
+template <class Iterator> auto when_all(Iterator first, Iterator last, const pplx::task_options& options)
+{
+    using value_type = typename std::iterator_traits<Iterator>::value_type::result_type;
+    std::vector<task<value_type>> inputs(first, last);
+    if(inputs.empty()) return task_from_result(std::vector<value_type>{});
+
+    std::vector<std::shared_ptr<details::shared_state<value_type>>> states;
+    for(const auto& input : inputs)
+        states.push_back(input.m_state);
+    auto node = details::make_state<details::when_all_node<value_type>>(get_memory_resource(), std::move(inputs),
+                                                                        options.get_scheduler());
+    for(const auto& state : states)
+        state->attach(node);
+    return task<std::vector<value_type>>{std::move(node)};
+}
+
+} // namespace expected_task::native
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "expected_task.hpp"
+
+#include <concepts>
+#include <utility>
+
+namespace expected_task
+{
+
+namespace details
+{
+
+    // the stages are named types rather than lambdas : a lambda type would embed the whole pipeline type, making the
+    // type names (and the debug information) grow exponentially with the number of stages. They only accept a
+    // tl::expected, so that pplx sees them as value-based continuations.
+
+    struct identity_stage
+    {
+        template <class T>
+        requires is_expected_v<std::remove_cvref_t<T>> T operator()(T&& value) const
+        {
+            return std::forward<T>(value);
+        }
+    };
+
+    template <class FCT> struct map_stage
+    {
+        FCT callback;
+
+        template <class Expected>
+        requires is_expected_v<Expected> auto operator()(Expected res)
+        {
+            return std::move(res).map(callback);
+        }
+    };
+
+    template <class FCT> struct and_then_stage
+    {
+        FCT callback;
+
+        template <class Expected>
+        requires is_expected_v<Expected> auto operator()(Expected res)
+        {
+            return std::move(res).and_then(callback);
+        }
+    };
+
+    template <class FCT> struct map_error_stage
+    {
+        FCT callback;
+
+        template <class Expected>
+        requires is_expected_v<Expected> auto operator()(Expected res)
+        {
+            return std::move(res).map_error(callback);
+        }
+    };
+
+    template <class FCT> struct or_else_stage
+    {
+        FCT callback;
+
+        template <class Expected>
+        requires is_expected_v<Expected> Expected operator()(Expected res)
+        {
+            return std::move(res).or_else(callback);
+        }
+    };
+
+    template <class Previous, class Stage> struct composed_stage
+    {
+        Previous previous;
+        Stage stage;
+
+        template <class Expected>
+        requires is_expected_v<Expected> auto operator()(Expected res)
+        {
+            return stage(previous(std::move(res)));
+        }
+    };
+
+} // namespace details
+
+/**
+ * @brief lazily builds a chain of synchronous stages on top of an expected_task, and runs them all in a single
+ * continuation.
+ *
+ * then_map, and_then, map_error and or_else only accept callbacks that don't return any kind of task : end the
+ * pipeline with run() to chain asynchronous stages on the resulting expected_task.
+ */
+template <class SourceValue, class SourceError, class Stages = details::identity_stage> class pipeline
+{
+public:
+    using source_type = expected_task<SourceValue, SourceError>;
+    using source_expected_type = typename source_type::expected_type;
+    using expected_type = std::invoke_result_t<Stages&, source_expected_type>;
+    using value_type = typename expected_type::value_type;
+    using error_type = typename expected_type::error_type;
+    using result_type = expected_task<value_type, error_type>;
+
+    explicit pipeline(source_type source, Stages stages = {})
+        : m_source{std::move(source)}
+        , m_stages{std::move(stages)}
+    {
+    }
+
+    /**
+     * @brief the stages are copied along with the source : chain from an rvalue to move them into the new pipeline
+     * instead.
+     */
+    template <class FCT>
+    requires(std::is_same_v<value_type, void>&& std::invocable<FCT>)
+        || std::invocable<FCT, value_type> auto then_map(FCT&& callback) const&
+    {
+        return pipeline{*this}.then_map(std::forward<FCT>(callback));
+    }
+
+    template <class FCT>
+    requires(std::is_same_v<value_type, void>&& std::invocable<FCT>)
+        || std::invocable<FCT, value_type> auto then_map(FCT&& callback) &&
+    {
+        using callback_result_type = details::callback_return_type_t<FCT, value_type>;
+        static_assert(!details::is_task_v<callback_result_type> && !details::is_expected_task_v<callback_result_type>,
+                      "only synchronous callbacks can be fused, use run() before chaining asynchronous ones");
+        static_assert(details::is_expected_v<callback_result_type> == false,
+                      "use and_then with functions returning expected");
+        return std::move(*this).add_stage(details::map_stage<std::decay_t<FCT>>{std::forward<FCT>(callback)});
+    }
+
+    template <class FCT>
+    requires(std::is_same_v<value_type, void>&& std::invocable<FCT>)
+        || std::invocable<FCT, value_type> auto and_then(FCT&& callback) const&
+    {
+        return pipeline{*this}.and_then(std::forward<FCT>(callback));
+    }
+
+    template <class FCT>
+    requires(std::is_same_v<value_type, void>&& std::invocable<FCT>)
+        || std::invocable<FCT, value_type> auto and_then(FCT&& callback) &&
+    {
+        using callback_result_type = details::callback_return_type_t<FCT, value_type>;
+        static_assert(details::is_expected_v<callback_result_type>,
+                      "only synchronous callbacks returning expected can be fused with and_then");
+        static_assert(std::is_convertible_v<typename callback_result_type::error_type, error_type>,
+                      "error types must match");
+        return std::move(*this).add_stage(details::and_then_stage<std::decay_t<FCT>>{std::forward<FCT>(callback)});
+    }
+
+    template <class FCT>
+    requires std::invocable<FCT, error_type>
+    auto map_error(FCT&& callback) const&
+    {
+        return pipeline{*this}.map_error(std::forward<FCT>(callback));
+    }
+
+    template <class FCT>
+    requires std::invocable<FCT, error_type>
+    auto map_error(FCT&& callback) &&
+    {
+        using callback_result_type = std::invoke_result_t<FCT, error_type>;
+        static_assert(details::is_task_v<callback_result_type> == false,
+                      "only synchronous callbacks can be fused, use run() before chaining asynchronous ones");
+        return std::move(*this).add_stage(details::map_error_stage<std::decay_t<FCT>>{std::forward<FCT>(callback)});
+    }
+
+    template <class FCT>
+    requires std::invocable<FCT, error_type>
+    auto or_else(FCT&& callback) const&
+    {
+        return pipeline{*this}.or_else(std::forward<FCT>(callback));
+    }
+
+    template <class FCT>
+    requires std::invocable<FCT, error_type>
+    auto or_else(FCT&& callback) &&
+    {
+        using callback_result_type = std::invoke_result_t<FCT, error_type>;
+        static_assert(!details::is_task_v<callback_result_type> && !details::is_expected_task_v<callback_result_type>,
+                      "only synchronous callbacks can be fused, use run() before chaining asynchronous ones");
+        return std::move(*this).add_stage(details::or_else_stage<std::decay_t<FCT>>{std::forward<FCT>(callback)});
+    }
+
+    /**
+     * @brief schedules all the stages as a single continuation of the source, or runs them inline if the source is
+     * ready.
+     */
+    result_type run(const pplx::task_options& options = {}) const&
+    {
+        return source_type{m_source}.template continue_with_result<result_type>(Stages{m_stages}, options);
+    }
+
+    result_type run(const pplx::task_options& options = {}) &&
+    {
+        return std::move(m_source).template continue_with_result<result_type>(std::move(m_stages), options);
+    }
+
+    operator result_type() const&
+    {
+        return run();
+    }
+
+    operator result_type() &&
+    {
+        return std::move(*this).run();
+    }
+
+    /**
+     * @brief runs the pipeline and returns its result, blocking if it isn't finished.
+     */
+    auto get() const
+    {
+        return run().get();
+    }
+
+private:
+    source_type m_source;
+    Stages m_stages;
+
+    /**
+     * @brief moves the source and the stages into the pipeline with one more stage : building a pipeline of n stages
+     * from rvalues moves each callable instead of copying all of them at each stage.
+     */
+    template <class Stage> auto add_stage(Stage stage) &&
+    {
+        using composed_type = details::composed_stage<Stages, Stage>;
+        return pipeline<SourceValue, SourceError, composed_type>{std::move(m_source),
+                                                                 composed_type{std::move(m_stages), std::move(stage)}};
+    }
+};
+
+template <class Value, class Error> pipeline(expected_task<Value, Error>) -> pipeline<Value, Error>;
+
+} // namespace expected_task
+
+template <class SourceValue, class SourceError, class Stages, class Callback>
+auto operator>=(expected_task::pipeline<SourceValue, SourceError, Stages>&& p, Callback&& callback)
+{
+    return std::move(p).then_map(std::forward<Callback>(callback));
+}
+
+template <class SourceValue, class SourceError, class Stages, class Callback>
+auto operator>=(const expected_task::pipeline<SourceValue, SourceError, Stages>& p, Callback&& callback)
+{
+    return p.then_map(std::forward<Callback>(callback));
+}
+
+template <class SourceValue, class SourceError, class Stages, class Callback>
+auto operator>>=(expected_task::pipeline<SourceValue, SourceError, Stages>&& p, Callback&& callback)
+{
+    return std::move(p).and_then(std::forward<Callback>(callback));
+}
+
+template <class SourceValue, class SourceError, class Stages, class Callback>
+auto operator>>=(const expected_task::pipeline<SourceValue, SourceError, Stages>& p, Callback&& callback)
+{
+    return p.and_then(std::forward<Callback>(callback));
+}
+
+template <class SourceValue, class SourceError, class Stages, class Callback>
+auto operator|=(expected_task::pipeline<SourceValue, SourceError, Stages>&& p, Callback&& callback)
+{
+    return std::move(p).map_error(std::forward<Callback>(callback));
+}
+
+template <class SourceValue, class SourceError, class Stages, class Callback>
+auto operator|=(const expected_task::pipeline<SourceValue, SourceError, Stages>& p, Callback&& callback)
+{
+    return p.map_error(std::forward<Callback>(callback));
+}
+
+template <class SourceValue, class SourceError, class Stages, class Callback>
+auto operator||(expected_task::pipeline<SourceValue, SourceError, Stages>&& p, Callback&& callback)
+{
+    return std::move(p).or_else(std::forward<Callback>(callback));
+}
+
+template <class SourceValue, class SourceError, class Stages, class Callback>
+auto operator||(const expected_task::pipeline<SourceValue, SourceError, Stages>& p, Callback&& callback)
+{
+    return p.or_else(std::forward<Callback>(callback));
+}
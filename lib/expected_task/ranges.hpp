@@ -0,0 +1,46 @@
+#pragma once
+
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+
+namespace expected_task
+{
+
+namespace details
+{
+
+    template <class Range> struct is_owning_view : std::false_type
+    {
+    };
+
+    template <class Range> struct is_owning_view<std::ranges::owning_view<Range>> : std::true_type
+    {
+    };
+
+    /**
+     * @brief whether the elements of a range, given as a forwarding reference, can be moved out of it : its
+     * iterators give rvalues, or it is an rvalue container or owning_view. Other views, such as a filter over an
+     * lvalue container, only refer to elements owned by the caller, and are copied from.
+     */
+    template <class Range>
+    constexpr bool moves_elements_v
+        = !std::is_lvalue_reference_v<std::ranges::range_reference_t<Range>>
+          || (!std::is_lvalue_reference_v<Range>
+              && (!std::ranges::view<std::remove_cvref_t<Range>> || is_owning_view<std::remove_cvref_t<Range>>::value));
+
+    /**
+     * @brief the element the iterator points to, moved out of the range if moves_elements_v allows it, and copied
+     * otherwise.
+     */
+    template <class Range> std::ranges::range_value_t<Range> take_element(const std::ranges::iterator_t<Range>& it)
+    {
+        if constexpr(moves_elements_v<Range>)
+            return std::ranges::iter_move(it);
+        else
+            return *it;
+    }
+
+} // namespace details
+
+} // namespace expected_task
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "async_state.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace expected_task
+{
+
+/**
+ * @brief how retry makes its attempts.
+ *
+ * The n-th retry waits for initial_delay * multiplier^(n - 1), capped at max_delay, minus a random part of up to
+ * jitter times this delay : 0 waits for the exact backoff, 1 for a delay drawn uniformly up to it. Only the errors for
+ * which retry_on returns true are retried, or all of them if it is empty.
+ */
+template <class E = std::wstring> struct retry_policy
+{
+    std::size_t max_attempts = 3;
+    std::chrono::steady_clock::duration initial_delay = std::chrono::milliseconds{100};
+    double multiplier = 2.;
+    std::chrono::steady_clock::duration max_delay = std::chrono::seconds{10};
+    double jitter = 0.5;
+    std::function<bool(const E&)> retry_on = {};
+};
+
+namespace details
+{
+
+    /**
+     * @brief a random number in [0, 1), from a generator of the calling thread.
+     */
+    inline double random_fraction()
+    {
+        thread_local std::minstd_rand generator{std::random_device{}()};
+        return std::uniform_real_distribution<double>{0., 1.}(generator);
+    }
+
+    /**
+     * @brief the attempts of a retry, made one after the other.
+     *
+     * Attempts are started by the previous one finishing, or by a timer once their delay has passed : nothing waits
+     * in between, and the state is the same whatever the number of attempts. Attempts which fail right away without
+     * delay are made in a loop, without growing the stack. A delay is cut short by the cancellation of the token.
+     */
+    template <class Factory, class T, class E>
+    class retry_state : public async_state<retry_state<Factory, T, E>, tl::expected<T, E>>
+    {
+    public:
+        using expected_type = tl::expected<T, E>;
+
+        retry_state(Factory factory, retry_policy<E> policy, const pplx::task_options& options, timer_wheel& wheel)
+            : async_state<retry_state, expected_type>{options}
+            , m_factory{std::move(factory)}
+            , m_policy{std::move(policy)}
+            , m_token{options.get_cancellation_token()}
+            , m_wheel{wheel}
+            , m_delay{m_policy.initial_delay}
+        {
+        }
+
+        /**
+         * @brief the callback watching the token is deregistered once the retry is done with. It can't be running
+         * unless the token is cancelled, and is then left alone : it may be the one releasing the retry.
+         */
+        ~retry_state()
+        {
+            if(m_registration && !m_token.is_canceled()) m_token.deregister_callback(*m_registration);
+        }
+
+        void attempt()
+        {
+            while(true)
+            {
+                if(m_token.is_canceled()) return void(m_event.set(cancelled<expected_type>()));
+                ++m_attempts;
+                std::optional<expected_task<T, E>> task;
+                try
+                {
+                    task.emplace(std::invoke(m_factory));
+                }
+                catch(...)
+                {
+                    return void(m_event.set_exception(std::current_exception()));
+                }
+                if(!task->is_ready())
+                {
+                    std::move(*task).to_task().then([self = this->shared_from_this()](backend::task<expected_type> done)
+                                                    { self->on_done(std::move(done)); },
+                                                    backend_options(m_options));
+                    return;
+                }
+                const auto delay = finish_or_next_delay(std::move(*task).get());
+                if(!delay) return;
+                if(*delay > clock::duration::zero()) return wait(*delay);
+            }
+        }
+
+    private:
+        using clock = std::chrono::steady_clock;
+        using async_state<retry_state, expected_type>::m_event;
+        using async_state<retry_state, expected_type>::m_options;
+
+        Factory m_factory;
+        const retry_policy<E> m_policy;
+        const pplx::cancellation_token m_token;
+        timer_wheel& m_wheel;
+        clock::duration m_delay;
+        std::size_t m_attempts = 0;
+        std::optional<pplx::cancellation_token_registration> m_registration;
+        std::mutex m_mutex;
+        timer_id m_timer;
+        bool m_waiting = false;
+
+        void on_done(backend::task<expected_type> done)
+        {
+            std::optional<clock::duration> delay;
+            try
+            {
+                delay = finish_or_next_delay(std::move(done).get());
+            }
+            catch(...)
+            {
+                return void(m_event.set_exception(std::current_exception()));
+            }
+            if(!delay) return;
+            if(*delay > clock::duration::zero()) return wait(*delay);
+            attempt();
+        }
+
+        /**
+         * @brief the delay before the next attempt, or nothing once the result is final : the retry is then completed
+         * with it.
+         */
+        std::optional<clock::duration> finish_or_next_delay(expected_type res)
+        {
+            if(res || m_attempts >= m_policy.max_attempts || (m_policy.retry_on && !m_policy.retry_on(res.error())))
+            {
+                m_event.set(std::move(res));
+                return std::nullopt;
+            }
+            const auto backoff = m_delay;
+            m_delay = std::min(std::chrono::duration_cast<clock::duration>(m_delay * m_policy.multiplier),
+                               m_policy.max_delay);
+            return std::chrono::duration_cast<clock::duration>(
+                backoff * (1. - std::clamp(m_policy.jitter, 0., 1.) * random_fraction()));
+        }
+
+        /**
+         * @brief the next attempt is made once the delay has passed, unless the token is cancelled first : the timer is
+         * then cancelled, and the retry finishes right away. The token is watched from the first delay on.
+         */
+        void wait(const clock::duration delay)
+        {
+            if(!m_registration && m_token.is_cancelable())
+                m_registration = m_token.register_callback(
+                    [weak = std::weak_ptr<retry_state>{this->shared_from_this()}]()
+                    {
+                        if(const auto self = weak.lock()) self->cancel_wait();
+                    });
+            std::lock_guard<std::mutex> lock{m_mutex};
+            // cancelled before the callback could see the delay
+            if(m_token.is_canceled()) return void(m_event.set(cancelled<expected_type>()));
+            m_waiting = true;
+            m_timer = this->schedule_after(m_wheel, delay,
+                                           [](retry_state& state)
+                                           {
+                                               if(state.end_wait()) state.attempt();
+                                           });
+        }
+
+        /**
+         * @brief returns true if the delay is still running, ending it : the timer and the token can't both end it.
+         */
+        bool end_wait()
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            return std::exchange(m_waiting, false);
+        }
+
+        void cancel_wait()
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            if(!std::exchange(m_waiting, false)) return;
+            const auto timer = m_timer;
+            lock.unlock();
+            m_wheel.cancel(timer);
+            m_event.set(cancelled<expected_type>());
+        }
+    };
+
+} // namespace details
+
+/**
+ * @brief calls the factory, and calls it again as long as the expected_task it returns fails, as told by the policy.
+ * Completes with the first value, or with the last error.
+ *
+ * The delays between the attempts are timers of the wheel : no thread sleeps, and the memory used is the same
+ * whatever the number of attempts. Exceptions, thrown by the factory or by its tasks, are forwarded without being
+ * retried. Once the cancellation token of the options is cancelled, no other attempt is made, and the retry finishes
+ * with the cancellation_error of E, right away if it is waiting for its next attempt. The continuations and the
+ * resulting task run on the scheduler given in the options, if any.
+ */
+template <std::invocable Factory>
+requires details::is_expected_task_v<std::invoke_result_t<Factory&>>
+auto retry(Factory factory, retry_policy<typename std::invoke_result_t<Factory&>::error_type> policy = {},
+           const pplx::task_options& options = {}, timer_wheel& wheel = timer_wheel::shared())
+    -> std::invoke_result_t<Factory&>
+{
+    using result_type = std::invoke_result_t<Factory&>;
+    using state_type
+        = details::retry_state<Factory, typename result_type::value_type, typename result_type::error_type>;
+    return details::start_state<result_type>(
+        std::make_shared<state_type>(std::move(factory), std::move(policy), options, wheel), options,
+        [](state_type& state) { state.attempt(); });
+}
+
+} // namespace expected_task
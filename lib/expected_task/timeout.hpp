@@ -0,0 +1,240 @@
+#pragma once
+
+#include "expected_task.hpp"
+#include "timer_wheel.hpp"
+
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace expected_task
+{
+
+namespace details
+{
+
+    /**
+     * @brief the result of a with_deadline : the result of the task, or the error once the timer expires, whichever
+     * comes first.
+     */
+    template <class T, class E> class timeout_state
+    {
+    public:
+        using expected_type = tl::expected<T, E>;
+
+        explicit timeout_state(E error)
+            : m_error{std::move(error)}
+        {
+        }
+
+        backend::task<expected_type> result() const
+        {
+            return backend::create_task(m_event);
+        }
+
+        /**
+         * @brief the error is set from a task, so that the continuations don't run on the thread of the wheel.
+         */
+        void start(backend::task<expected_type> task, const timer_wheel::clock::time_point deadline,
+                   timer_wheel& wheel, const std::shared_ptr<timeout_state>& self, const pplx::task_options& options)
+        {
+            // the timer is known before the task can finish and cancel it
+            m_timer = wheel.schedule_at(deadline,
+                                        [self, options = backend_options(options)]()
+                                        { backend::create_task([self]() { self->expire(); }, options); });
+            task.then(
+                [self, &wheel](backend::task<expected_type> done)
+                {
+                    wheel.cancel(self->m_timer);
+                    self->complete(std::move(done));
+                });
+        }
+
+    private:
+        backend::task_completion_event<expected_type> m_event;
+        E m_error;
+        timer_id m_timer;
+
+        void expire()
+        {
+            m_event.set(expected_type{tl::make_unexpected(std::move(m_error))});
+        }
+
+        void complete(backend::task<expected_type> task)
+        {
+            try
+            {
+                m_event.set(std::move(task).get());
+            }
+            catch(...)
+            {
+                m_event.set_exception(std::current_exception());
+            }
+        }
+    };
+
+} // namespace details
+
+/**
+ * @brief the result of the task, or the error if the task isn't done by the deadline.
+ *
+ * The deadline is kept by a timer of the wheel, cancelled as soon as the task finishes : no thread waits for it. The
+ * task itself isn't stopped, and its result is dropped if it comes too late : see deadline to also skip the stages
+ * left. A ready task is returned as is. The resulting task runs on the scheduler given in the options, if any.
+ *
+ * E is deduced from the task only : the error can be anything converting to it, such as a string literal.
+ */
+template <class T, class E>
+expected_task<T, E> with_deadline(expected_task<T, E> task, const timer_wheel::clock::time_point deadline,
+                                  std::type_identity_t<E> error, const pplx::task_options& options = {},
+                                  timer_wheel& wheel = timer_wheel::shared())
+{
+    if(task.is_ready()) return task;
+    const auto state = std::make_shared<details::timeout_state<T, E>>(std::move(error));
+    state->start(std::move(task).to_task(), deadline, wheel, state, options);
+    expected_task<T, E> result{state->result()};
+    if(options.has_scheduler()) return std::move(result).schedule_on(options);
+    return result;
+}
+
+/**
+ * @brief the result of the task, or the error if the task isn't done after the timeout : see with_deadline.
+ */
+template <class T, class E>
+expected_task<T, E> with_timeout(expected_task<T, E> task, const timer_wheel::clock::duration timeout,
+                                 std::type_identity_t<E> error, const pplx::task_options& options = {},
+                                 timer_wheel& wheel = timer_wheel::shared())
+{
+    return with_deadline(std::move(task), timer_wheel::clock::now() + timeout, std::move(error), options, wheel);
+}
+
+/**
+ * @brief a deadline shared by the stages of a chain.
+ *
+ * Its options carry a cancellation token, cancelled once the deadline has passed : given to the first stage of a
+ * chain, they are inherited by all the following ones, which are then skipped. Binding the chain gives its result, or
+ * the error of the deadline once it has passed, even if a stage is still running. A single timer runs per deadline,
+ * whatever the number of stages and chains bound to it. The timer keeps the deadline until it passes, even once the
+ * deadline is destroyed : the chains bound to it, and the stages given its options, still get the error and the
+ * cancellation. A bound chain is forgotten by the deadline as soon as it finishes, so that a long-lived deadline
+ * doesn't grow with the chains.
+ *
+ * Copies share the same deadline.
+ */
+template <class E = std::wstring> class deadline
+{
+public:
+    using clock = timer_wheel::clock;
+
+    deadline(const clock::time_point at, E error, timer_wheel& wheel = timer_wheel::shared())
+        : m_state{std::make_shared<state>(std::move(error))}
+    {
+        // the deadline expires from a task, so that the stages skipped and the bound chains don't run on the thread
+        // of the wheel
+        wheel.schedule_at(at, [expiring = m_state]() { backend::create_task([expiring]() { expiring->expire(); }); });
+    }
+
+    deadline(const clock::duration timeout, E error, timer_wheel& wheel = timer_wheel::shared())
+        : deadline{clock::now() + timeout, std::move(error), wheel}
+    {
+    }
+
+    /**
+     * @brief options cancelling the stages once the deadline has passed. To run the stages on a scheduler as well,
+     * construct pplx::task_options{deadline.options().get_cancellation_token(), scheduler}.
+     */
+    pplx::task_options options() const
+    {
+        return pplx::task_options{m_state->source.get_token()};
+    }
+
+    bool has_passed() const
+    {
+        return m_state->source.get_token().is_canceled();
+    }
+
+    /**
+     * @brief the result of the chain, or the error of the deadline once it has passed. A ready chain is returned as
+     * is.
+     */
+    template <class T> expected_task<T, E> bind(expected_task<T, E> chain) const
+    {
+        using expected_type = tl::expected<T, E>;
+        if(chain.is_ready()) return chain;
+        backend::task_completion_event<expected_type> event;
+        typename state::waiter_list::iterator waiter;
+        {
+            std::lock_guard<std::mutex> lock{m_state->mutex};
+            if(m_state->passed) return tl::make_unexpected(m_state->error);
+            waiter = m_state->waiters.insert(m_state->waiters.end(), [event](const E& error)
+                                             { event.set(expected_type{tl::make_unexpected(error)}); });
+        }
+        std::move(chain).to_task().then(
+            [event, bound = m_state, waiter](backend::task<expected_type> done)
+            {
+                bound->forget(waiter);
+                try
+                {
+                    event.set(std::move(done).get());
+                }
+                catch(...)
+                {
+                    event.set_exception(std::current_exception());
+                }
+            });
+        return expected_task<T, E>{backend::create_task(event)};
+    }
+
+private:
+    struct state
+    {
+        using waiter_list = std::list<std::function<void(const E&)>>;
+
+        E error;
+        pplx::cancellation_token_source source;
+        std::mutex mutex;
+        waiter_list waiters;
+        bool passed = false;
+
+        explicit state(E err)
+            : error{std::move(err)}
+        {
+        }
+
+        /**
+         * @brief drops the waiter of a chain which finished. Once the deadline has passed, the waiters were handed to
+         * expire, which keeps them.
+         */
+        void forget(const typename waiter_list::iterator waiter)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if(!passed) waiters.erase(waiter);
+        }
+
+        /**
+         * @brief the bound chains get the error before the token is cancelled, so that they never finish with the
+         * error of a skipped stage instead.
+         */
+        void expire()
+        {
+            waiter_list expired;
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                passed = true;
+                expired.swap(waiters);
+            }
+            for(const auto& waiter : expired)
+                waiter(error);
+            source.cancel();
+        }
+    };
+
+    std::shared_ptr<state> m_state;
+};
+
+} // namespace expected_task
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace expected_task
+{
+
+/**
+ * @brief a timer of a timer_wheel, to cancel it.
+ */
+struct timer_id
+{
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0;
+};
+
+/**
+ * @brief runs callbacks at given times from a single thread, for any number of timers.
+ *
+ * A hierarchical timer wheel : 4 levels of 256 slots, each slot of a level spanning a whole turn of the level below.
+ * Scheduling and cancelling a timer are O(1), and a timer is only moved down once per level on its way to expiring.
+ * The timers are kept in a pool of nodes, reused once they expire or are cancelled : a timer doesn't allocate,
+ * besides the captures of its callback which don't fit in a std::function. The thread only wakes up when a timer
+ * expires, or when the timers of an upper level must be moved down.
+ *
+ * Timers never expire early, and are late by up to a tick, plus the time to run the callbacks expiring before them :
+ * callbacks must be short, completing a task for instance, and must not throw. The timers left when the wheel is
+ * destroyed are dropped without running.
+ */
+class timer_wheel
+{
+public:
+    using clock = std::chrono::steady_clock;
+    using callback_type = std::function<void()>;
+
+    explicit timer_wheel(const clock::duration tick = std::chrono::milliseconds{1})
+        : m_tick{std::max(tick, clock::duration{1})}
+        , m_epoch{clock::now()}
+    {
+        m_slots.fill(npos);
+        m_thread = std::thread{[this]() { run(); }};
+    }
+
+    timer_wheel(const timer_wheel&) = delete;
+    timer_wheel& operator=(const timer_wheel&) = delete;
+
+    ~timer_wheel()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_stopping = true;
+        }
+        m_condition.notify_one();
+        m_thread.join();
+    }
+
+    /**
+     * @brief the wheel of the timeouts, with a tick of 1 ms, started on first use.
+     */
+    static timer_wheel& shared()
+    {
+        static timer_wheel wheel;
+        return wheel;
+    }
+
+    timer_id schedule_at(const clock::time_point deadline, callback_type callback)
+    {
+        bool earlier;
+        timer_id timer;
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            // an empty wheel skips the ticks it slept through
+            if(m_size == 0) m_current = std::max(m_current, elapsed_ticks(clock::now()));
+            timer.index = allocate();
+            auto& added = at(timer.index);
+            timer.generation = added.generation;
+            added.deadline = deadline_ticks(deadline);
+            added.callback = std::move(callback);
+            place(timer.index);
+            ++m_size;
+            earlier = added.deadline < m_wakeup;
+            if(earlier) m_wakeup = added.deadline;
+        }
+        if(earlier) m_condition.notify_one();
+        return timer;
+    }
+
+    timer_id schedule_after(const clock::duration delay, callback_type callback)
+    {
+        return schedule_at(clock::now() + delay, std::move(callback));
+    }
+
+    /**
+     * @brief cancels the timer, unless it has already expired : returns true if its callback won't run.
+     */
+    bool cancel(const timer_id timer)
+    {
+        // destroyed once unlocked, as it may hold the last reference to an object cancelling timers
+        callback_type dropped;
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if(timer.index >= m_nb_nodes) return false;
+        auto& cancelled = at(timer.index);
+        if(!cancelled.pending || cancelled.generation != timer.generation) return false;
+        unlink(timer.index);
+        dropped = std::move(cancelled.callback);
+        release(timer.index);
+        --m_size;
+        return true;
+    }
+
+    /**
+     * @brief the number of timers waiting to expire.
+     */
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        return m_size;
+    }
+
+private:
+    static constexpr std::size_t level_bits = 8;
+    static constexpr std::size_t nb_slots = std::size_t{1} << level_bits;
+    static constexpr std::size_t slot_mask = nb_slots - 1;
+    static constexpr std::size_t nb_levels = 4;
+    static constexpr std::uint64_t max_delta = (std::uint64_t{1} << (level_bits * nb_levels)) - 1;
+    static constexpr std::size_t chunk_size = 4096;
+    static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::uint64_t never = std::numeric_limits<std::uint64_t>::max();
+
+    /**
+     * @brief a timer, linked in the list of its slot while pending, or in the free list otherwise.
+     */
+    struct node
+    {
+        // in ticks since the epoch
+        std::uint64_t deadline = 0;
+        callback_type callback;
+        std::uint32_t prev = npos;
+        std::uint32_t next = npos;
+        std::uint32_t generation = 0;
+        std::uint16_t slot = 0;
+        bool pending = false;
+    };
+
+    const clock::duration m_tick;
+    const clock::time_point m_epoch;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    // nodes are never moved, so that growing the pool doesn't stop the wheel
+    std::vector<std::unique_ptr<node[]>> m_chunks;
+    std::uint32_t m_nb_nodes = 0;
+    std::uint32_t m_free = npos;
+    std::array<std::uint32_t, nb_levels * nb_slots> m_slots;
+    // the next tick to process
+    std::uint64_t m_current = 0;
+    // the tick the thread sleeps until
+    std::uint64_t m_wakeup = never;
+    std::size_t m_size = 0;
+    bool m_stopping = false;
+    std::thread m_thread;
+
+    node& at(const std::uint32_t index)
+    {
+        return m_chunks[index / chunk_size][index % chunk_size];
+    }
+
+    std::uint64_t elapsed_ticks(const clock::time_point time) const
+    {
+        if(time <= m_epoch) return 0;
+        return static_cast<std::uint64_t>((time - m_epoch) / m_tick);
+    }
+
+    /**
+     * @brief the first tick at or after the deadline, so that timers never expire early.
+     */
+    std::uint64_t deadline_ticks(const clock::time_point deadline) const
+    {
+        if(deadline <= m_epoch) return 0;
+        return static_cast<std::uint64_t>((deadline - m_epoch + m_tick - clock::duration{1}) / m_tick);
+    }
+
+    std::uint32_t allocate()
+    {
+        std::uint32_t index = m_free;
+        if(index != npos)
+            m_free = at(index).next;
+        else
+        {
+            if(m_nb_nodes % chunk_size == 0) m_chunks.push_back(std::make_unique<node[]>(chunk_size));
+            index = m_nb_nodes++;
+        }
+        auto& allocated = at(index);
+        ++allocated.generation;
+        allocated.pending = true;
+        return index;
+    }
+
+    void release(const std::uint32_t index)
+    {
+        auto& released = at(index);
+        released.pending = false;
+        released.next = m_free;
+        m_free = index;
+    }
+
+    /**
+     * @brief links the timer in the slot of the lowest level whose turn covers its deadline.
+     */
+    void place(const std::uint32_t index)
+    {
+        auto& placed = at(index);
+        const auto delta = std::min(placed.deadline > m_current ? placed.deadline - m_current : 0, max_delta);
+        const auto tick = m_current + delta;
+        std::size_t level = 0;
+        while(level + 1 < nb_levels && delta >= (std::uint64_t{1} << (level_bits * (level + 1))))
+            ++level;
+        link(index, static_cast<std::uint16_t>(level * nb_slots + ((tick >> (level_bits * level)) & slot_mask)));
+    }
+
+    void link(const std::uint32_t index, const std::uint16_t slot)
+    {
+        auto& linked = at(index);
+        linked.slot = slot;
+        linked.prev = npos;
+        linked.next = m_slots[slot];
+        if(linked.next != npos) at(linked.next).prev = index;
+        m_slots[slot] = index;
+    }
+
+    void unlink(const std::uint32_t index)
+    {
+        auto& unlinked = at(index);
+        if(unlinked.prev != npos)
+            at(unlinked.prev).next = unlinked.next;
+        else
+            m_slots[unlinked.slot] = unlinked.next;
+        if(unlinked.next != npos) at(unlinked.next).prev = unlinked.prev;
+    }
+
+    /**
+     * @brief processes the current tick : moves the timers of the upper levels down at the start of each turn, and
+     * takes the callbacks of the timers expiring.
+     */
+    void advance(std::vector<callback_type>& expired)
+    {
+        const auto index = static_cast<std::uint16_t>(m_current & slot_mask);
+        for(std::size_t level = 1; level < nb_levels && (m_current >> (level_bits * (level - 1)) & slot_mask) == 0;
+            ++level)
+            cascade(static_cast<std::uint16_t>(level * nb_slots + ((m_current >> (level_bits * level)) & slot_mask)));
+        for(auto it = std::exchange(m_slots[index], npos); it != npos;)
+        {
+            auto& current = at(it);
+            const auto next = current.next;
+            if(current.deadline <= m_current)
+            {
+                expired.push_back(std::move(current.callback));
+                release(it);
+                --m_size;
+            }
+            else
+                place(it);
+            it = next;
+        }
+        ++m_current;
+    }
+
+    void cascade(const std::uint16_t slot)
+    {
+        for(auto it = std::exchange(m_slots[slot], npos); it != npos;)
+        {
+            const auto next = at(it).next;
+            place(it);
+            it = next;
+        }
+    }
+
+    /**
+     * @brief the next tick with timers expiring in the current turn of the first level, or else the start of the
+     * next turn. The start of a turn is always processed, to move the timers of the upper levels down.
+     */
+    std::uint64_t next_tick() const
+    {
+        if((m_current & slot_mask) == 0) return m_current;
+        const auto turn_end = (m_current | slot_mask) + 1;
+        for(auto tick = m_current; tick < turn_end; ++tick)
+            if(m_slots[tick & slot_mask] != npos) return tick;
+        return turn_end;
+    }
+
+    void run()
+    {
+        std::vector<callback_type> expired;
+        std::unique_lock<std::mutex> lock{m_mutex};
+        while(!m_stopping)
+        {
+            if(m_size == 0)
+            {
+                m_wakeup = never;
+                m_condition.wait(lock);
+                continue;
+            }
+            const auto now = elapsed_ticks(clock::now());
+            for(auto next = next_tick(); m_size != 0 && next <= now; next = next_tick())
+            {
+                m_current = next;
+                advance(expired);
+            }
+            if(m_current <= now) m_current = now + 1;
+            if(!expired.empty())
+            {
+                lock.unlock();
+                for(auto& callback : expired)
+                    callback();
+                expired.clear();
+                lock.lock();
+                continue;
+            }
+            m_wakeup = next_tick();
+            m_condition.wait_until(lock, m_epoch + m_tick * static_cast<clock::rep>(m_wakeup));
+        }
+    }
+};
+
+} // namespace expected_task
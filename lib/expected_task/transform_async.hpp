@@ -0,0 +1,208 @@
+#pragma once
+
+#include "expected_task.hpp"
+#include "ranges.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace expected_task
+{
+
+namespace details
+{
+
+    template <class View, class FCT>
+    using transform_result_t = std::invoke_result_t<FCT&, std::ranges::range_value_t<View>>;
+
+    /**
+     * @brief the inputs of a transform_async left to start, and the results of the ones started, in order.
+     *
+     * At most max_in_flight tasks are running at any time : each one finishing starts the next input. Tasks which are
+     * ready right away are handled in a loop, without growing the stack.
+     */
+    template <class View, class FCT>
+    class transform_state : public std::enable_shared_from_this<transform_state<View, FCT>>
+    {
+    public:
+        using task_type = transform_result_t<View, FCT>;
+        using value_type = typename task_type::value_type;
+        using error_type = typename task_type::error_type;
+        using result_type = tl::expected<std::vector<value_type>, error_type>;
+
+        transform_state(View inputs, FCT fct, const std::size_t max_in_flight, const pplx::task_options& options)
+            : m_inputs{std::move(inputs)}
+            , m_next{std::ranges::begin(m_inputs)}
+            , m_fct{std::move(fct)}
+            , m_max_in_flight{std::max<std::size_t>(max_in_flight, 1)}
+            , m_options{options}
+            , m_token{options.get_cancellation_token()}
+        {
+            if constexpr(std::ranges::sized_range<View>) m_results.reserve(std::ranges::size(m_inputs));
+        }
+
+        backend::task<result_type> result() const
+        {
+            return backend::create_task(m_event);
+        }
+
+        /**
+         * @brief starts inputs until max_in_flight tasks are running, or there aren't any left.
+         */
+        void pump()
+        {
+            while(auto started = start_next())
+            {
+                auto& [index, task] = *started;
+                if(task.is_ready())
+                    on_done(index, std::move(task).get());
+                else
+                    std::move(task).to_task().then(
+                        [state = this->shared_from_this(), index = index](backend::task<expected_type> done)
+                        {
+                            state->on_done(index, std::move(done));
+                            state->pump();
+                        },
+                        backend_options(m_options));
+            }
+        }
+
+    private:
+        using expected_type = tl::expected<value_type, error_type>;
+
+        backend::task_completion_event<result_type> m_event;
+        std::mutex m_mutex;
+        View m_inputs;
+        std::ranges::iterator_t<View> m_next;
+        FCT m_fct;
+        const std::size_t m_max_in_flight;
+        const pplx::task_options m_options;
+        const pplx::cancellation_token m_token;
+        std::vector<std::optional<value_type>> m_results;
+        std::size_t m_in_flight = 0;
+        bool m_done = false;
+
+        /**
+         * @brief the index and task of the next input, if another task may run. Completes once the last task is done,
+         * or with the cancellation error once the token is cancelled.
+         */
+        std::optional<std::pair<std::size_t, task_type>> start_next()
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            if(m_done) return std::nullopt;
+            if(m_token.is_canceled())
+            {
+                m_done = true;
+                lock.unlock();
+                m_event.set(cancelled<result_type>());
+                return std::nullopt;
+            }
+            if(m_in_flight == m_max_in_flight) return std::nullopt;
+            if(m_next == std::ranges::end(m_inputs))
+            {
+                if(m_in_flight == 0) complete(std::move(lock));
+                return std::nullopt;
+            }
+            const auto index = m_results.size();
+            m_results.emplace_back();
+            ++m_in_flight;
+            auto input = take_element<View>(m_next);
+            ++m_next;
+            lock.unlock();
+            try
+            {
+                return std::pair{index, std::invoke(m_fct, std::move(input))};
+            }
+            catch(...)
+            {
+                fail(std::current_exception());
+                return std::nullopt;
+            }
+        }
+
+        void on_done(const std::size_t index, backend::task<expected_type> task)
+        {
+            try
+            {
+                on_done(index, std::move(task).get());
+            }
+            catch(...)
+            {
+                fail(std::current_exception());
+            }
+        }
+
+        void on_done(const std::size_t index, expected_type res)
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            --m_in_flight;
+            if(m_done) return;
+            if(res)
+                return void(m_results[index].emplace(std::move(*res)));
+            m_done = true;
+            lock.unlock();
+            m_event.set(result_type{tl::make_unexpected(std::move(res.error()))});
+        }
+
+        void complete(std::unique_lock<std::mutex> lock)
+        {
+            m_done = true;
+            std::vector<value_type> values;
+            values.reserve(m_results.size());
+            for(auto& value : m_results)
+                values.push_back(std::move(*value));
+            lock.unlock();
+            m_event.set(result_type{std::move(values)});
+        }
+
+        void fail(std::exception_ptr exception)
+        {
+            {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                if(m_done) return;
+                m_done = true;
+            }
+            m_event.set_exception(std::move(exception));
+        }
+    };
+
+} // namespace details
+
+/**
+ * @brief maps fct, returning an expected_task, over the inputs with at most max_in_flight tasks running at once :
+ * each task finishing starts the next input. Completes with the values in the order of the inputs, or with the first
+ * error as soon as a task fails, without starting any other input.
+ *
+ * fct is called from the continuations of the tasks finishing, outside of any lock : with max_in_flight above 1, it
+ * may be called from several threads at once, and must be safe to call concurrently.
+ *
+ * The inputs are only gone through as the tasks are started, so a lazy range is never materialized. An rvalue range
+ * is kept by the resulting task, and an lvalue range must outlive it. The inputs are moved into fct only out of an
+ * rvalue container or owning_view : they are copied from any other view, such as a filter over a container of the
+ * caller, which keeps them intact. The continuations starting the next inputs run on the scheduler given in the
+ * options, if any, as does the resulting task. Once the cancellation token of the options is cancelled, no other input
+ * is started, and the next task to finish completes the result with the cancellation_error of E.
+ */
+template <std::ranges::input_range Range, class FCT>
+requires details::is_expected_task_v<details::transform_result_t<std::views::all_t<Range>, FCT>>
+auto transform_async(Range&& inputs, FCT fct, const std::size_t max_in_flight, const pplx::task_options& options = {})
+{
+    using state_type = details::transform_state<std::views::all_t<Range>, FCT>;
+    using task_type = typename state_type::task_type;
+    using result_type = expected_task<std::vector<typename task_type::value_type>, typename task_type::error_type>;
+    const auto state
+        = std::make_shared<state_type>(std::views::all(std::forward<Range>(inputs)), std::move(fct), max_in_flight,
+                                       options);
+    result_type result{state->result()};
+    state->pump();
+    if(options.has_scheduler()) return std::move(result).schedule_on(options);
+    return result;
+}
+
+} // namespace expected_task
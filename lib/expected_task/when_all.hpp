@@ -1,49 +1,546 @@
 #pragma once
 
 #include "expected_task.hpp"
+#include "ranges.hpp"
 
 #include <algorithm>
-#include <numeric>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace expected_task
 {
 
-namespace details
+/**
+ * @brief when_all policy waiting for all the tasks, and stacking all their errors with the delimiter : the default.
+ *
+ * The stacked error is built in a single allocation, in linear time.
+ */
+template <class E> struct aggregate_errors
 {
+    E delimiter;
 
-    template <class T, class E> E stackErrors(std::vector<tl::expected<T, E>> results, const E& delimiter)
+    E operator()(std::vector<E> errors) const
     {
-        const auto it = std::remove_if(begin(results), end(results), std::mem_fn(&tl::expected<T, E>::has_value));
-        return std::accumulate(begin(results), it, E{}, [&delimiter](const E& acc, const tl::expected<T, E>& exp) {
-            if(acc == E{})
-                return exp.error();
-            else
-                return acc + delimiter + exp.error();
-        });
+        E stacked{};
+        if constexpr(requires { stacked.reserve(std::size_t{}); })
+        {
+            std::size_t size = 0;
+            for(const auto& error : errors)
+                size += error.size() + delimiter.size();
+            stacked.reserve(size);
+        }
+        for(auto& error : errors)
+        {
+            if(stacked != E{}) stacked += delimiter;
+            stacked += std::move(error);
+        }
+        return stacked;
     }
+};
 
-} // namespace details
+/**
+ * @brief when_all policy waiting for all the tasks, and completing with the vector of all their errors, in the order
+ * of the tasks.
+ */
+struct collect_errors
+{
+    template <class E> std::vector<E> operator()(std::vector<E> errors) const
+    {
+        return errors;
+    }
+};
+
+/**
+ * @brief when_all policy waiting for all the tasks, and completing with the error of the first failing one in the
+ * order of the tasks : for error codes and other errors which cannot be stacked.
+ */
+struct first_error
+{
+    template <class E> E operator()(std::vector<E> errors) const
+    {
+        return std::move(errors.front());
+    }
+};
+
+/**
+ * @brief a policy turning the errors of a when_all, in the order of the tasks, into a single error.
+ */
+template <class Aggregator, class E>
+concept error_aggregator = std::invocable<const Aggregator&, std::vector<E>>;
+
+/**
+ * @brief when_all policy completing with the first error, or the first exception, without waiting for the other
+ * tasks.
+ *
+ * If a cancellation_token_source is given, it is cancelled on the first error : the remaining tasks created with its
+ * token are then cancelled. The native engine ignores cancellation tokens, and only stops waiting for them.
+ */
+struct fail_fast
+{
+    std::optional<pplx::cancellation_token_source> cancel_remaining;
+};
+
+/**
+ * @brief any input range of expected_tasks : containers, spans, views...
+ */
+template <class Range>
+concept expected_task_range
+    = std::ranges::input_range<Range> && details::is_expected_task_v<std::ranges::range_value_t<Range>>;
 
-template <class T, class E>
-expected_task<std::vector<T>, E> when_all(const std::vector<expected_task<T, E>>& tasks, const E& delimiter = L" && ")
+namespace details
 {
-    std::vector<pplx::task<tl::expected<T, E>>> pplx_tasks(tasks.size());
-    std::transform(begin(tasks), end(tasks), std::begin(pplx_tasks), std::mem_fn(&expected_task<T, E>::to_task));
 
-    using Expected_type = tl::expected<T, E>;
-    return when_all(begin(pplx_tasks), end(pplx_tasks))
-        .then([delimiter](std::vector<Expected_type> results) -> tl::expected<std::vector<T>, E> {
-            if(std::all_of(begin(results), end(results), std::mem_fn(&Expected_type::has_value)))
+    template <class Range> using range_value_type_t = typename std::ranges::range_value_t<Range>::value_type;
+    template <class Range> using range_error_type_t = typename std::ranges::range_value_t<Range>::error_type;
+
+    /**
+     * @brief the backend tasks of the range, moving the expected_tasks out of it as take_element does.
+     */
+    template <class Range> auto to_backend_tasks(Range&& tasks)
+    {
+        using value_type = std::ranges::range_value_t<Range>;
+        std::vector<typename value_type::task_type> backend_tasks;
+        if constexpr(std::ranges::sized_range<Range>) backend_tasks.reserve(std::ranges::size(tasks));
+        for(auto it = std::ranges::begin(tasks); it != std::ranges::end(tasks); ++it)
+            backend_tasks.push_back(take_element<Range>(it).to_task());
+        return backend_tasks;
+    }
+
+    template <class Aggregator, class E>
+    using aggregated_error_t = std::invoke_result_t<const Aggregator&, std::vector<E>>;
+
+    /**
+     * @brief moves the errors out of the results, in order.
+     */
+    template <class T, class E> std::vector<E> take_errors(std::vector<tl::expected<T, E>>& results)
+    {
+        std::vector<E> errors;
+        errors.reserve(std::count_if(begin(results), end(results), [](const auto& res) { return !res; }));
+        for(auto& res : results)
+            if(!res) errors.push_back(std::move(res.error()));
+        return errors;
+    }
+
+    /**
+     * @brief the values of all the results, or their errors turned into one by the aggregator.
+     */
+    template <class T, class E, class Aggregator>
+    tl::expected<std::vector<T>, aggregated_error_t<Aggregator, E>> gather(std::vector<tl::expected<T, E>> results,
+                                                                          const Aggregator& aggregator)
+    {
+        if(!std::all_of(begin(results), end(results), std::mem_fn(&tl::expected<T, E>::has_value)))
+            return tl::make_unexpected(aggregator(take_errors(results)));
+        std::vector<T> values;
+        values.reserve(results.size());
+        for(auto& value : results)
+            values.push_back(std::move(*value));
+        return values;
+    }
+
+    /**
+     * @brief results gathered by a fail_fast when_all, completing its task once all the values are there or on the
+     * first failure.
+     */
+    template <class T, class E> class fail_fast_state
+    {
+    public:
+        using expected_type = tl::expected<T, E>;
+        using result_type = tl::expected<std::vector<T>, E>;
+
+        fail_fast_state(const std::size_t size, std::optional<pplx::cancellation_token_source> cancel_remaining,
+                        pplx::cancellation_token token)
+            : m_values(size)
+            , m_remaining{size}
+            , m_cancel_remaining{std::move(cancel_remaining)}
+            , m_token{std::move(token)}
+        {
+        }
+
+        backend::task<result_type> result() const
+        {
+            return backend::create_task(m_event);
+        }
+
+        void on_done(const std::size_t index, backend::task<expected_type> task)
+        {
+            if(m_token.is_canceled())
+            {
+                if(claim()) m_event.set(cancelled<result_type>());
+                return observe(task);
+            }
+            std::optional<expected_type> res;
+            try
+            {
+                res.emplace(std::move(task).get());
+            }
+            catch(...)
+            {
+                if(claim()) m_event.set_exception(std::current_exception());
+                return;
+            }
+            if(!*res)
+            {
+                if(claim()) m_event.set(result_type{tl::make_unexpected(std::move(res->error()))});
+                return;
+            }
+            m_values[index].emplace(std::move(**res));
+            if(m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 && claim()) m_event.set(collect());
+        }
+
+    private:
+        backend::task_completion_event<result_type> m_event;
+        std::vector<std::optional<T>> m_values;
+        std::atomic<std::size_t> m_remaining;
+        std::atomic_flag m_done = ATOMIC_FLAG_INIT;
+        std::optional<pplx::cancellation_token_source> m_cancel_remaining;
+        const pplx::cancellation_token m_token;
+
+        /**
+         * @brief returns true the first time only, cancelling the remaining tasks if the result is a failure.
+         */
+        bool claim()
+        {
+            if(m_done.test_and_set(std::memory_order_acq_rel)) return false;
+            if(m_cancel_remaining && m_remaining.load(std::memory_order_acquire) != 0) m_cancel_remaining->cancel();
+            return true;
+        }
+
+        result_type collect()
+        {
+            std::vector<T> values;
+            values.reserve(m_values.size());
+            for(auto& value : m_values)
+                values.push_back(std::move(*value));
+            return values;
+        }
+    };
+
+    /**
+     * @brief results of a when_all moving the values straight into a buffer of the caller.
+     *
+     * Failures are rare : they are only gathered, under a lock, to be aggregated in the order of the tasks at the end.
+     * Once the token is cancelled, the values of the tasks finishing are dropped, and the result is the cancellation
+     * error : the buffer is never written to once the resulting task is done.
+     */
+    template <class T, class E, class Aggregator> class gather_state
+    {
+    public:
+        using result_type = tl::expected<std::span<T>, aggregated_error_t<Aggregator, E>>;
+
+        gather_state(const std::span<T> output, const std::size_t size, Aggregator aggregator,
+                     pplx::cancellation_token token)
+            : m_output{output}
+            , m_remaining{size}
+            , m_aggregator{std::move(aggregator)}
+            , m_token{std::move(token)}
+        {
+        }
+
+        backend::task<result_type> result() const
+        {
+            return backend::create_task(m_event);
+        }
+
+        void on_done(const std::size_t index, backend::task<tl::expected<T, E>> task)
+        {
+            if(m_token.is_canceled())
             {
-                std::vector<T> res(results.size());
-                std::transform(begin(results), end(results), begin(res), [](auto& v) { return *v; });
-                return res;
+                m_cancelled.store(true, std::memory_order_relaxed);
+                observe(task);
             }
             else
+                store(index, std::move(task));
+            if(m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) complete();
+        }
+
+    private:
+        using failure = std::pair<std::size_t, std::variant<tl::expected<T, E>, std::exception_ptr>>;
+
+        backend::task_completion_event<result_type> m_event;
+        std::span<T> m_output;
+        std::atomic<std::size_t> m_remaining;
+        Aggregator m_aggregator;
+        const pplx::cancellation_token m_token;
+        std::atomic<bool> m_cancelled{false};
+        std::mutex m_failures_mutex;
+        std::vector<failure> m_failures;
+
+        void store(const std::size_t index, backend::task<tl::expected<T, E>> task)
+        {
+            try
+            {
+                auto res = std::move(task).get();
+                if(res)
+                    m_output[index] = std::move(*res);
+                else
+                    add_failure(index, std::move(res));
+            }
+            catch(...)
+            {
+                add_failure(index, std::current_exception());
+            }
+        }
+
+        template <class Failure> void add_failure(const std::size_t index, Failure failure)
+        {
+            std::lock_guard<std::mutex> lock{m_failures_mutex};
+            m_failures.emplace_back(index, std::move(failure));
+        }
+
+        void complete()
+        {
+            if(m_cancelled.load(std::memory_order_relaxed)) return void(m_event.set(cancelled<result_type>()));
+            if(m_failures.empty()) return void(m_event.set(result_type{m_output}));
+            std::sort(begin(m_failures), end(m_failures),
+                      [](const failure& lhs, const failure& rhs) { return lhs.first < rhs.first; });
+            for(auto& [index, failure] : m_failures)
+                if(auto* const exception = std::get_if<std::exception_ptr>(&failure))
+                    return void(m_event.set_exception(*exception));
+            std::vector<E> errors;
+            errors.reserve(m_failures.size());
+            for(auto& [index, failure] : m_failures)
+                errors.push_back(std::move(std::get<tl::expected<T, E>>(failure).error()));
+            m_event.set(result_type{tl::make_unexpected(m_aggregator(std::move(errors)))});
+        }
+    };
+
+    /**
+     * @brief the tuple of all the values, or the first error in the order of the tasks.
+     */
+    template <class E, class... Ts, std::size_t... I>
+    tl::expected<std::tuple<Ts...>, E> combine(std::tuple<std::optional<tl::expected<Ts, E>>...>& results,
+                                               std::index_sequence<I...>)
+    {
+        std::optional<E> error;
+        ((!error && !*std::get<I>(results) ? void(error.emplace(std::move(std::get<I>(results)->error()))) : void()),
+         ...);
+        if(error) return tl::make_unexpected(std::move(*error));
+        return std::tuple<Ts...>{std::move(**std::get<I>(results))...};
+    }
+
+    /**
+     * @brief results gathered by a heterogeneous when_all, stored inline until the last task is done.
+     */
+    template <class E, class... Ts> class tuple_state
+    {
+    public:
+        using result_type = tl::expected<std::tuple<Ts...>, E>;
+
+        explicit tuple_state(pplx::cancellation_token token)
+            : m_token{std::move(token)}
+        {
+        }
+
+        backend::task<result_type> result() const
+        {
+            return backend::create_task(m_event);
+        }
+
+        template <std::size_t I>
+        void on_done(backend::task<tl::expected<std::tuple_element_t<I, std::tuple<Ts...>>, E>> task)
+        {
+            try
             {
-                return tl::make_unexpected(details::stackErrors(results, delimiter));
+                std::get<I>(m_results).emplace(std::move(task).get());
             }
-        });
+            catch(...)
+            {
+                m_exceptions[I] = std::current_exception();
+            }
+            if(m_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            for(const auto& exception : m_exceptions)
+                if(exception) return void(m_event.set_exception(exception));
+            if(m_token.is_canceled()) return void(m_event.set(cancelled<result_type>()));
+            m_event.set(combine(m_results, std::index_sequence_for<Ts...>{}));
+        }
+
+    private:
+        backend::task_completion_event<result_type> m_event;
+        std::tuple<std::optional<tl::expected<Ts, E>>...> m_results;
+        std::array<std::exception_ptr, sizeof...(Ts)> m_exceptions;
+        std::atomic<std::size_t> m_remaining{sizeof...(Ts)};
+        const pplx::cancellation_token m_token;
+    };
+
+    template <class E, class... Ts, std::size_t... I>
+    expected_task<std::tuple<Ts...>, E> when_all_of(std::tuple<expected_task<Ts, E>...> tasks,
+                                                     std::index_sequence<I...> indices,
+                                                     const pplx::task_options& options)
+    {
+        using result_type = tl::expected<std::tuple<Ts...>, E>;
+        if((std::get<I>(tasks).is_ready() && ...))
+        {
+            if(options.get_cancellation_token().is_canceled()) return cancelled<result_type>();
+            std::tuple<std::optional<tl::expected<Ts, E>>...> results{std::move(std::get<I>(tasks)).get()...};
+            expected_task<std::tuple<Ts...>, E> ready{combine(results, indices)};
+            if(options.has_scheduler()) return std::move(ready).schedule_on(options);
+            return ready;
+        }
+        const auto state = std::make_shared<tuple_state<E, Ts...>>(options.get_cancellation_token());
+        (std::move(std::get<I>(tasks))
+             .to_task()
+             .then([state](backend::task<tl::expected<Ts, E>> task) { state->template on_done<I>(std::move(task)); },
+                   backend_options(options)),
+         ...);
+        expected_task<std::tuple<Ts...>, E> result{state->result()};
+        if(options.has_scheduler()) return std::move(result).schedule_on(options);
+        return result;
+    }
+
+} // namespace details
+
+/**
+ * @brief completes with the values of all the tasks, in order, or once they are all done with their errors turned
+ * into one by the aggregator : aggregate_errors, collect_errors, first_error or any callable taking the vector of the
+ * errors.
+ *
+ * Takes any range of expected_tasks : they are moved out of an rvalue container or owning_view, and copied
+ * otherwise, from views over a container of the caller as well. The values are moved into the resulting vector. The
+ * resulting task runs on the scheduler given in the options, if any. Once the cancellation token of the options is
+ * cancelled, the result is the cancellation_error of the aggregated error, as for the stages of a chain.
+ */
+template <expected_task_range Range, error_aggregator<details::range_error_type_t<Range>> Aggregator>
+auto when_all(Range&& tasks, Aggregator aggregator, const pplx::task_options& options = {})
+    -> expected_task<std::vector<details::range_value_type_t<Range>>,
+                     details::aggregated_error_t<Aggregator, details::range_error_type_t<Range>>>
+{
+    using Expected_type = tl::expected<details::range_value_type_t<Range>, details::range_error_type_t<Range>>;
+    using Result_type = tl::expected<std::vector<details::range_value_type_t<Range>>,
+                                     details::aggregated_error_t<Aggregator, details::range_error_type_t<Range>>>;
+    auto backend_tasks = details::to_backend_tasks(std::forward<Range>(tasks));
+    return backend::when_all(begin(backend_tasks), end(backend_tasks), details::backend_options(options))
+        .then(
+            [aggregator = std::move(aggregator),
+             token = options.get_cancellation_token()](std::vector<Expected_type> results) -> Result_type
+            {
+                if(token.is_canceled()) return details::cancelled<Result_type>();
+                return details::gather(std::move(results), aggregator);
+            },
+            details::backend_options(options));
+}
+
+/**
+ * @brief the errors are stacked with the delimiter.
+ */
+template <expected_task_range Range>
+auto when_all(Range&& tasks, const pplx::task_options& options,
+              const details::range_error_type_t<Range>& delimiter = L" && ")
+{
+    return when_all(std::forward<Range>(tasks), aggregate_errors<details::range_error_type_t<Range>>{delimiter},
+                    options);
+}
+
+template <expected_task_range Range>
+auto when_all(Range&& tasks, const details::range_error_type_t<Range>& delimiter = L" && ")
+{
+    return when_all(std::forward<Range>(tasks), pplx::task_options{}, delimiter);
+}
+
+/**
+ * @brief same as when_all, moving the values into the output buffer instead of a new vector : the resulting task
+ * gives back its first elements, one per task, once all the values are there.
+ *
+ * The buffer must be at least as big as the range, or std::invalid_argument is thrown before any task is waited for.
+ * It must also outlive the resulting task. Each value is moved into the buffer as soon as its task is done, without
+ * any intermediate storage : on error, the buffer holds the values of the tasks which succeeded, and the errors are
+ * turned into one by the aggregator. Once the cancellation token of the options is cancelled, the values of the tasks
+ * finishing are dropped, and the result is the cancellation_error of the aggregated error.
+ */
+template <expected_task_range Range, error_aggregator<details::range_error_type_t<Range>> Aggregator>
+auto when_all(Range&& tasks, const std::span<details::range_value_type_t<Range>> output, Aggregator aggregator,
+              const pplx::task_options& options = {})
+    -> expected_task<std::span<details::range_value_type_t<Range>>,
+                     details::aggregated_error_t<Aggregator, details::range_error_type_t<Range>>>
+{
+    using T = details::range_value_type_t<Range>;
+    using E = details::range_error_type_t<Range>;
+    using state_type = details::gather_state<T, E, Aggregator>;
+    auto backend_tasks = details::to_backend_tasks(std::forward<Range>(tasks));
+    if(output.size() < backend_tasks.size())
+        throw std::invalid_argument{"the buffer of when_all must be as big as the range of tasks"};
+    const auto values = output.first(backend_tasks.size());
+    if(backend_tasks.empty()) return typename state_type::result_type{values};
+    const auto state = std::make_shared<state_type>(values, backend_tasks.size(), std::move(aggregator),
+                                                     options.get_cancellation_token());
+    for(std::size_t i = 0; i < backend_tasks.size(); ++i)
+        std::move(backend_tasks[i])
+            .then([state, i](backend::task<tl::expected<T, E>> task) { state->on_done(i, std::move(task)); },
+                  details::backend_options(options));
+    expected_task<std::span<T>, details::aggregated_error_t<Aggregator, E>> result{state->result()};
+    if(options.has_scheduler()) return std::move(result).schedule_on(options);
+    return result;
+}
+
+/**
+ * @brief the errors are stacked with the delimiter.
+ */
+template <expected_task_range Range>
+auto when_all(Range&& tasks, const std::span<details::range_value_type_t<Range>> output,
+              const pplx::task_options& options = {}, const details::range_error_type_t<Range>& delimiter = L" && ")
+{
+    return when_all(std::forward<Range>(tasks), output, aggregate_errors<details::range_error_type_t<Range>>{delimiter},
+                    options);
+}
+
+/**
+ * @brief completes with the values of all the tasks, in order, or with the first error as soon as a task fails.
+ *
+ * The checks run on the scheduler given in the options, if any, as does the resulting task. Once the cancellation
+ * token of the options is cancelled, the next task to finish completes it with the cancellation_error of E.
+ */
+template <expected_task_range Range>
+auto when_all(Range&& tasks, fail_fast policy, const pplx::task_options& options = {})
+    -> expected_task<std::vector<details::range_value_type_t<Range>>, details::range_error_type_t<Range>>
+{
+    using T = details::range_value_type_t<Range>;
+    using E = details::range_error_type_t<Range>;
+    auto backend_tasks = details::to_backend_tasks(std::forward<Range>(tasks));
+    if(backend_tasks.empty()) return tl::expected<std::vector<T>, E>{std::vector<T>{}};
+    const auto state = std::make_shared<details::fail_fast_state<T, E>>(
+        backend_tasks.size(), std::move(policy.cancel_remaining), options.get_cancellation_token());
+    for(std::size_t i = 0; i < backend_tasks.size(); ++i)
+        std::move(backend_tasks[i])
+            .then([state, i](backend::task<tl::expected<T, E>> task) { state->on_done(i, std::move(task)); },
+                  details::backend_options(options));
+    expected_task<std::vector<T>, E> result{state->result()};
+    if(options.has_scheduler()) return std::move(result).schedule_on(options);
+    return result;
+}
+
+/**
+ * @brief completes with the tuple of the values of tasks of different types, or with the first error in the order of
+ * the tasks once they are all done.
+ *
+ * The options come first, ahead of the tasks. The values are stored inline until the last task is done, and the
+ * result is ready right away if all the tasks are, unless the options give a scheduler : the checks run on it, as does
+ * the resulting task. Once the cancellation token of the options is cancelled, the result is the cancellation_error of
+ * E.
+ */
+template <class E, class... Ts>
+requires(sizeof...(Ts) > 0 && (!std::is_void_v<Ts> && ...)) expected_task<std::tuple<Ts...>, E> when_all(
+    const pplx::task_options& options, expected_task<Ts, E>... tasks)
+{
+    return details::when_all_of(std::tuple<expected_task<Ts, E>...>{std::move(tasks)...},
+                                std::index_sequence_for<Ts...>{}, options);
+}
+
+template <class E, class... Ts>
+requires(sizeof...(Ts) > 0 && (!std::is_void_v<Ts> && ...)) expected_task<std::tuple<Ts...>, E> when_all(
+    expected_task<Ts, E>... tasks)
+{
+    return when_all(pplx::task_options{}, std::move(tasks)...);
 }
 
 template <class T, class E> expected_task<std::vector<T>, E> operator&&(expected_task<T, E> t1, expected_task<T, E> t2)
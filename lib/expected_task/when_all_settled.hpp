@@ -0,0 +1,283 @@
+#pragma once
+
+#include "when_all.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace expected_task
+{
+
+/**
+ * @brief the results of a batch of tasks, each one a value or an error, stored compactly : the values contiguously,
+ * the errors with the index of their task, and the status of each task in a bitmap.
+ *
+ * Both the values and the errors are kept in the order of the tasks. Accessing one result by index costs a scan of
+ * the bitmap, one bit per task : iterate over values() and failures() instead when going through all of them.
+ */
+template <class T, class E> class settled_results
+{
+public:
+    using value_type = T;
+    using error_type = E;
+    using failure_type = std::pair<std::size_t, E>;
+
+    settled_results() = default;
+
+    explicit settled_results(std::vector<tl::expected<T, E>> results)
+    {
+        const auto nb_values = static_cast<std::size_t>(
+            std::count_if(begin(results), end(results), std::mem_fn(&tl::expected<T, E>::has_value)));
+        reserve(nb_values, results.size() - nb_values);
+        for(auto& res : results)
+            push_back(std::move(res));
+    }
+
+    /**
+     * @brief makes room for the results to come, so that pushing them back doesn't reallocate.
+     */
+    void reserve(const std::size_t nb_values, const std::size_t nb_failures)
+    {
+        m_values.reserve(nb_values);
+        m_failures.reserve(nb_failures);
+        m_succeeded.reserve((nb_values + nb_failures + bits_per_word - 1) / bits_per_word);
+    }
+
+    /**
+     * @brief appends the result of the next task.
+     */
+    void push_back(tl::expected<T, E> result)
+    {
+        if(m_size % bits_per_word == 0) m_succeeded.push_back(0);
+        if(result)
+        {
+            m_succeeded.back() |= std::uint64_t{1} << (m_size % bits_per_word);
+            m_values.push_back(std::move(*result));
+        }
+        else
+            m_failures.emplace_back(m_size, std::move(result.error()));
+        ++m_size;
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    bool succeeded(const std::size_t index) const
+    {
+        return (m_succeeded[index / bits_per_word] >> (index % bits_per_word)) & 1;
+    }
+
+    bool all_succeeded() const
+    {
+        return m_failures.empty();
+    }
+
+    /**
+     * @brief the values of the tasks which succeeded, in order.
+     */
+    std::span<const T> values() const
+    {
+        return m_values;
+    }
+
+    std::span<T> values()
+    {
+        return m_values;
+    }
+
+    /**
+     * @brief the index and error of the tasks which failed, in order.
+     */
+    std::span<const failure_type> failures() const
+    {
+        return m_failures;
+    }
+
+    /**
+     * @brief the indices of the tasks which failed, in order : the ones to submit again.
+     */
+    std::vector<std::size_t> failed_indices() const
+    {
+        std::vector<std::size_t> indices;
+        indices.reserve(m_failures.size());
+        for(const auto& failure : m_failures)
+            indices.push_back(failure.first);
+        return indices;
+    }
+
+    /**
+     * @brief a copy of the result of the task at this index.
+     */
+    tl::expected<T, E> operator[](const std::size_t index) const
+    {
+        if(succeeded(index)) return m_values[rank(index)];
+        const auto failure = std::lower_bound(begin(m_failures), end(m_failures), index,
+                                              [](const failure_type& f, const std::size_t i) { return f.first < i; });
+        return tl::make_unexpected(failure->second);
+    }
+
+private:
+    static constexpr std::size_t bits_per_word = 64;
+
+    std::vector<T> m_values;
+    std::vector<failure_type> m_failures;
+    std::vector<std::uint64_t> m_succeeded;
+    std::size_t m_size = 0;
+
+    /**
+     * @brief the position of the value of the task at this index : the number of successes before it.
+     */
+    std::size_t rank(const std::size_t index) const
+    {
+        std::size_t res = 0;
+        for(std::size_t word = 0; word < index / bits_per_word; ++word)
+            res += std::popcount(m_succeeded[word]);
+        const auto mask = (std::uint64_t{1} << (index % bits_per_word)) - 1;
+        return res + std::popcount(m_succeeded[index / bits_per_word] & mask);
+    }
+};
+
+namespace details
+{
+
+    /**
+     * @brief results of a when_all_settled, stored as their tasks finish : each value in the slot of its task, and
+     * the failures, which are rare, with the index of their task under a lock. They are moved into a settled_results
+     * once the last task is done.
+     *
+     * Once the token is cancelled, the results of the tasks finishing are dropped, and the result is the cancellation
+     * error.
+     */
+    template <class T, class E> class settle_state
+    {
+    public:
+        using result_type = tl::expected<settled_results<T, E>, E>;
+
+        settle_state(const std::size_t size, pplx::cancellation_token token)
+            : m_values(size)
+            , m_remaining{size}
+            , m_token{std::move(token)}
+        {
+        }
+
+        backend::task<result_type> result() const
+        {
+            return backend::create_task(m_event);
+        }
+
+        void on_done(const std::size_t index, backend::task<tl::expected<T, E>> task)
+        {
+            if(m_token.is_canceled())
+            {
+                m_cancelled.store(true, std::memory_order_relaxed);
+                observe(task);
+            }
+            else
+                store(index, std::move(task));
+            if(m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) complete();
+        }
+
+    private:
+        using failure = std::pair<std::size_t, std::variant<E, std::exception_ptr>>;
+
+        backend::task_completion_event<result_type> m_event;
+        std::vector<std::optional<T>> m_values;
+        std::atomic<std::size_t> m_remaining;
+        const pplx::cancellation_token m_token;
+        std::atomic<bool> m_cancelled{false};
+        std::mutex m_failures_mutex;
+        std::vector<failure> m_failures;
+
+        void store(const std::size_t index, backend::task<tl::expected<T, E>> task)
+        {
+            try
+            {
+                auto res = std::move(task).get();
+                if(res)
+                    m_values[index].emplace(std::move(*res));
+                else
+                    add_failure(index, std::move(res.error()));
+            }
+            catch(...)
+            {
+                add_failure(index, std::current_exception());
+            }
+        }
+
+        template <class Failure> void add_failure(const std::size_t index, Failure failure)
+        {
+            std::lock_guard<std::mutex> lock{m_failures_mutex};
+            m_failures.emplace_back(index, std::move(failure));
+        }
+
+        void complete()
+        {
+            if(m_cancelled.load(std::memory_order_relaxed)) return void(m_event.set(cancelled<result_type>()));
+            std::sort(begin(m_failures), end(m_failures),
+                      [](const failure& lhs, const failure& rhs) { return lhs.first < rhs.first; });
+            for(auto& [index, failure] : m_failures)
+                if(auto* const exception = std::get_if<std::exception_ptr>(&failure))
+                    return void(m_event.set_exception(*exception));
+            settled_results<T, E> results;
+            results.reserve(m_values.size() - m_failures.size(), m_failures.size());
+            auto next_failure = begin(m_failures);
+            for(auto& value : m_values)
+                if(value)
+                    results.push_back(std::move(*value));
+                else
+                    results.push_back(tl::make_unexpected(std::move(std::get<E>((next_failure++)->second))));
+            m_values = {};
+            m_event.set(result_type{std::move(results)});
+        }
+    };
+
+} // namespace details
+
+/**
+ * @brief completes with the result of every task, successes and errors alike, once they are all done : a failing
+ * task doesn't make the others' values go away.
+ *
+ * Takes any range of expected_tasks, and forwards the exception thrown by a task, as when_all. Each result is kept
+ * as soon as its task is done, without the vector of all the tl::expected a plain when_all builds first. The
+ * resulting task runs on the scheduler given in the options, if any. Once the cancellation token of the options is
+ * cancelled, it completes with the cancellation_error of E when the tasks are done.
+ */
+template <expected_task_range Range>
+auto when_all_settled(Range&& tasks, const pplx::task_options& options = {})
+    -> expected_task<settled_results<details::range_value_type_t<Range>, details::range_error_type_t<Range>>,
+                     details::range_error_type_t<Range>>
+{
+    using T = details::range_value_type_t<Range>;
+    using E = details::range_error_type_t<Range>;
+    using state_type = details::settle_state<T, E>;
+    auto backend_tasks = details::to_backend_tasks(std::forward<Range>(tasks));
+    if(backend_tasks.empty()) return typename state_type::result_type{settled_results<T, E>{}};
+    const auto state = std::make_shared<state_type>(backend_tasks.size(), options.get_cancellation_token());
+    for(std::size_t i = 0; i < backend_tasks.size(); ++i)
+        std::move(backend_tasks[i])
+            .then([state, i](backend::task<tl::expected<T, E>> task) { state->on_done(i, std::move(task)); },
+                  details::backend_options(options));
+    expected_task<settled_results<T, E>, E> result{state->result()};
+    if(options.has_scheduler()) return std::move(result).schedule_on(options);
+    return result;
+}
+
+} // namespace expected_task
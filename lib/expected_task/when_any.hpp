@@ -0,0 +1,243 @@
+#pragma once
+
+#include "when_all.hpp"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <vector>
+
+namespace expected_task
+{
+
+namespace details
+{
+
+    /**
+     * @brief state of a race between tasks : the first one to finish, or the first success, completes it.
+     *
+     * The tasks losing the race only release their reference once they finish, and their results are dropped, their
+     * exceptions observed. Once the token is cancelled, the next task to finish completes the race with the
+     * cancellation error.
+     */
+    template <class T, class E, class Aggregator = aggregate_errors<E>> class race_state
+    {
+    public:
+        using expected_type = tl::expected<T, E>;
+        using result_type = tl::expected<T, aggregated_error_t<Aggregator, E>>;
+
+        /**
+         * @brief a race for the first success : the failures are kept, to be reported once every task failed.
+         */
+        race_state(const std::size_t size, Aggregator aggregator,
+                   std::optional<pplx::cancellation_token_source> cancel_losers, pplx::cancellation_token token)
+            : m_errors(size)
+            , m_exceptions(size)
+            , m_remaining{size}
+            , m_aggregator{std::move(aggregator)}
+            , m_cancel_losers{std::move(cancel_losers)}
+            , m_token{std::move(token)}
+        {
+        }
+
+        /**
+         * @brief a race won by the first task to finish, whatever its result : nothing is kept for the losers.
+         */
+        race_state(std::optional<pplx::cancellation_token_source> cancel_losers, pplx::cancellation_token token)
+            : m_remaining{0}
+            , m_cancel_losers{std::move(cancel_losers)}
+            , m_token{std::move(token)}
+        {
+        }
+
+        backend::task<result_type> result() const
+        {
+            return backend::create_task(m_event);
+        }
+
+        /**
+         * @brief the first task to finish wins, whatever its result.
+         */
+        void on_any_done(backend::task<expected_type> task)
+        {
+            if(m_done.test(std::memory_order_acquire) || cancel()) return observe(task);
+            try
+            {
+                auto res = std::move(task).get();
+                if(claim()) m_event.set(std::move(res));
+            }
+            catch(...)
+            {
+                if(claim()) m_event.set_exception(std::current_exception());
+            }
+        }
+
+        /**
+         * @brief the first success wins ; once all the tasks failed, the first exception or the aggregated errors.
+         */
+        void on_success_done(const std::size_t index, backend::task<expected_type> task)
+        {
+            if(m_done.test(std::memory_order_acquire) || cancel()) return observe(task);
+            try
+            {
+                auto res = std::move(task).get();
+                if(res)
+                {
+                    if(claim()) m_event.set(result_type{std::move(*res)});
+                    return;
+                }
+                m_errors[index].emplace(std::move(res));
+            }
+            catch(...)
+            {
+                m_exceptions[index] = std::current_exception();
+            }
+            if(m_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1 || !claim()) return;
+            for(const auto& exception : m_exceptions)
+                if(exception) return void(m_event.set_exception(exception));
+            std::vector<E> errors;
+            errors.reserve(m_errors.size());
+            for(auto& error : m_errors)
+                errors.push_back(std::move(error->error()));
+            m_event.set(result_type{tl::make_unexpected(m_aggregator(std::move(errors)))});
+        }
+
+    private:
+        backend::task_completion_event<result_type> m_event;
+        std::vector<std::optional<expected_type>> m_errors;
+        std::vector<std::exception_ptr> m_exceptions;
+        std::atomic<std::size_t> m_remaining;
+        std::atomic_flag m_done = ATOMIC_FLAG_INIT;
+        Aggregator m_aggregator;
+        std::optional<pplx::cancellation_token_source> m_cancel_losers;
+        const pplx::cancellation_token m_token;
+
+        /**
+         * @brief completes the race with the cancellation error once the token is cancelled : returns true if so.
+         */
+        bool cancel()
+        {
+            if(!m_token.is_canceled()) return false;
+            if(claim()) m_event.set(cancelled<result_type>());
+            return true;
+        }
+
+        /**
+         * @brief returns true the first time only, cancelling the losers.
+         */
+        bool claim()
+        {
+            if(m_done.test_and_set(std::memory_order_acq_rel)) return false;
+            if(m_cancel_losers) m_cancel_losers->cancel();
+            return true;
+        }
+    };
+
+    /**
+     * @brief the expected_tasks of the range, taken out of it as take_element does : a race needs to look at all of
+     * them before waiting for any.
+     */
+    template <class Range> auto to_expected_tasks(Range&& tasks)
+    {
+        std::vector<std::ranges::range_value_t<Range>> taken;
+        if constexpr(std::ranges::sized_range<Range>) taken.reserve(std::ranges::size(tasks));
+        for(auto it = std::ranges::begin(tasks); it != std::ranges::end(tasks); ++it)
+            taken.push_back(take_element<Range>(it));
+        return taken;
+    }
+
+    template <class T, class E, class Aggregator, class OnDone>
+    expected_task<T, aggregated_error_t<Aggregator, E>> race(std::vector<backend::task<tl::expected<T, E>>> tasks,
+                                                             const std::shared_ptr<race_state<T, E, Aggregator>>& state,
+                                                             const pplx::task_options& options, OnDone on_done)
+    {
+        for(std::size_t i = 0; i < tasks.size(); ++i)
+            std::move(tasks[i]).then([state, i, on_done](backend::task<tl::expected<T, E>> task)
+                                     { on_done(*state, i, std::move(task)); },
+                                     backend_options(options));
+        expected_task<T, aggregated_error_t<Aggregator, E>> result{state->result()};
+        if(options.has_scheduler()) return std::move(result).schedule_on(options);
+        return result;
+    }
+
+} // namespace details
+
+/**
+ * @brief completes with the result of the first task to finish, success or error.
+ *
+ * Takes any range of expected_tasks, as when_all, but not an empty one : a race without any task has no result, and
+ * std::invalid_argument is thrown. A ready task wins right away, without waiting for the others.
+ *
+ * If a cancellation_token_source is given, it is cancelled once the race is won : the losers created with its token
+ * are then cancelled. Otherwise, their results are dropped when they finish. The checks run on the scheduler given in
+ * the options, if any, as does the resulting task. Once the cancellation token of the options is cancelled, the next
+ * task to finish completes the race with the cancellation_error of E.
+ */
+template <expected_task_range Range>
+auto when_any(Range&& tasks, const pplx::task_options& options = {},
+              std::optional<pplx::cancellation_token_source> cancel_losers = {})
+    -> expected_task<details::range_value_type_t<Range>, details::range_error_type_t<Range>>
+{
+    using T = details::range_value_type_t<Range>;
+    using E = details::range_error_type_t<Range>;
+    auto taken = details::to_expected_tasks(std::forward<Range>(tasks));
+    if(taken.empty()) throw std::invalid_argument{"when_any needs at least one task"};
+    for(auto& task : taken)
+        if(task.is_ready())
+        {
+            if(cancel_losers) cancel_losers->cancel();
+            if(options.get_cancellation_token().is_canceled()) return details::cancelled<tl::expected<T, E>>();
+            if(options.has_scheduler()) return std::move(task).schedule_on(options);
+            return std::move(task);
+        }
+    std::vector<backend::task<tl::expected<T, E>>> backend_tasks;
+    backend_tasks.reserve(taken.size());
+    for(auto& task : taken)
+        backend_tasks.push_back(std::move(task).to_task());
+    const auto state
+        = std::make_shared<details::race_state<T, E>>(std::move(cancel_losers), options.get_cancellation_token());
+    return details::race(std::move(backend_tasks), state, options,
+                         [](details::race_state<T, E>& race, std::size_t, backend::task<tl::expected<T, E>> task)
+                         { race.on_any_done(std::move(task)); });
+}
+
+/**
+ * @brief completes with the first success, or once every task failed with their errors turned into one by the
+ * aggregator, in the order of the tasks : see the policies of when_all.
+ *
+ * An exception counts as a failure, and is rethrown if every task failed. The range, losers and cancellation token of
+ * the options are handled as with when_any : an empty range throws std::invalid_argument.
+ */
+template <expected_task_range Range, error_aggregator<details::range_error_type_t<Range>> Aggregator>
+auto first_success(Range&& tasks, Aggregator aggregator, const pplx::task_options& options = {},
+                   std::optional<pplx::cancellation_token_source> cancel_losers = {})
+    -> expected_task<details::range_value_type_t<Range>,
+                     details::aggregated_error_t<Aggregator, details::range_error_type_t<Range>>>
+{
+    using T = details::range_value_type_t<Range>;
+    using E = details::range_error_type_t<Range>;
+    using state_type = details::race_state<T, E, Aggregator>;
+    auto backend_tasks = details::to_backend_tasks(std::forward<Range>(tasks));
+    if(backend_tasks.empty()) throw std::invalid_argument{"first_success needs at least one task"};
+    const auto state = std::make_shared<state_type>(backend_tasks.size(), std::move(aggregator),
+                                                    std::move(cancel_losers), options.get_cancellation_token());
+    return details::race(std::move(backend_tasks), state, options,
+                         [](state_type& race, const std::size_t index, backend::task<tl::expected<T, E>> task)
+                         { race.on_success_done(index, std::move(task)); });
+}
+
+/**
+ * @brief the errors are stacked with the delimiter.
+ */
+template <expected_task_range Range>
+auto first_success(Range&& tasks, const pplx::task_options& options = {},
+                   const details::range_error_type_t<Range>& delimiter = L" && ",
+                   std::optional<pplx::cancellation_token_source> cancel_losers = {})
+{
+    return first_success(std::forward<Range>(tasks), aggregate_errors<details::range_error_type_t<Range>>{delimiter},
+                         options, std::move(cancel_losers));
+}
+
+} // namespace expected_task
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <pplx/pplxtasks.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace expected_task
+{
+
+/**
+ * @brief pplx scheduler running its jobs on a fixed number of threads, each one owning a deque of jobs.
+ *
+ * A job scheduled by a worker goes at the back of its own deque, where the worker takes it back first (its data is
+ * still in cache). Jobs scheduled from any other thread are spread over the workers. A worker running out of jobs
+ * steals the oldest job of another worker before going to sleep.
+ *
+ * Pass it to create_task, to any chaining method or to when_all through pplx::task_options, as a
+ * std::shared_ptr<work_stealing_executor>.
+ */
+class work_stealing_executor : public pplx::scheduler_interface
+{
+public:
+    explicit work_stealing_executor(const std::size_t nb_threads = std::thread::hardware_concurrency())
+        : m_state{std::make_shared<shared_state>(std::max<std::size_t>(nb_threads, 1))}
+    {
+        m_threads.reserve(m_state->queues.size());
+        for(std::size_t i = 0; i < m_state->queues.size(); ++i)
+            m_threads.emplace_back([state = m_state, i]() { run(state, i); });
+    }
+
+    work_stealing_executor(const work_stealing_executor&) = delete;
+    work_stealing_executor& operator=(const work_stealing_executor&) = delete;
+
+    /**
+     * @brief runs the remaining jobs, and then joins the workers.
+     */
+    ~work_stealing_executor()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_state->sleep_mutex};
+            m_state->stopping = true;
+        }
+        m_state->wake_up.notify_all();
+        // the last reference to the executor can be released by one of its own jobs : that worker keeps the shared
+        // state alive until it returns
+        for(auto& thread : m_threads)
+            if(thread.get_id() == std::this_thread::get_id())
+                thread.detach();
+            else
+                thread.join();
+    }
+
+    void schedule(pplx::TaskProc_t proc, void* param) override
+    {
+        auto& state = *m_state;
+        const auto index = t_current == &state ? t_index : state.next_queue.fetch_add(1) % state.queues.size();
+        // counted before being pushed : a worker taking the job right away must not bring the count below zero
+        state.nb_pending.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock{state.queues[index].mutex};
+            state.queues[index].jobs.emplace_back(proc, param);
+        }
+        if(state.nb_sleeping.load() > 0)
+        {
+            // taking the lock makes sure the sleeping worker is waiting, and can't miss the notification
+            {
+                std::lock_guard<std::mutex> lock{state.sleep_mutex};
+            }
+            state.wake_up.notify_one();
+        }
+    }
+
+    std::size_t size() const
+    {
+        return m_state->queues.size();
+    }
+
+    /**
+     * @brief number of jobs scheduled and not started yet.
+     */
+    std::size_t nb_pending() const
+    {
+        return m_state->nb_pending.load();
+    }
+
+    /**
+     * @brief returns true when called from one of the executor's workers.
+     */
+    bool owns_current_thread() const
+    {
+        return t_current == m_state.get();
+    }
+
+private:
+    using job = std::pair<pplx::TaskProc_t, void*>;
+
+    struct worker_queue
+    {
+        std::mutex mutex;
+        std::deque<job> jobs;
+    };
+
+    /**
+     * @brief everything the workers use, shared with them so that they can outlive the executor.
+     */
+    struct shared_state
+    {
+        explicit shared_state(const std::size_t nb_queues)
+            : queues(nb_queues)
+        {
+        }
+
+        std::vector<worker_queue> queues;
+        std::atomic<std::size_t> next_queue{0};
+        std::atomic<std::size_t> nb_pending{0};
+        std::atomic<std::size_t> nb_sleeping{0};
+        std::mutex sleep_mutex;
+        std::condition_variable wake_up;
+        bool stopping = false;
+    };
+
+    std::shared_ptr<shared_state> m_state;
+    std::vector<std::thread> m_threads;
+
+    inline static thread_local const shared_state* t_current = nullptr;
+    inline static thread_local std::size_t t_index = 0;
+
+    static std::optional<job> pop(shared_state& state, const std::size_t index)
+    {
+        auto& queue = state.queues[index];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        if(queue.jobs.empty()) return std::nullopt;
+        const auto res = queue.jobs.back();
+        queue.jobs.pop_back();
+        return res;
+    }
+
+    static std::optional<job> steal(shared_state& state, const std::size_t thief)
+    {
+        for(std::size_t i = 1; i < state.queues.size(); ++i)
+        {
+            auto& queue = state.queues[(thief + i) % state.queues.size()];
+            std::lock_guard<std::mutex> lock{queue.mutex};
+            if(queue.jobs.empty()) continue;
+            const auto res = queue.jobs.front();
+            queue.jobs.pop_front();
+            return res;
+        }
+        return std::nullopt;
+    }
+
+    static void run(const std::shared_ptr<shared_state> state_ptr, const std::size_t index)
+    {
+        auto& state = *state_ptr;
+        t_current = &state;
+        t_index = index;
+        while(true)
+        {
+            auto next = pop(state, index);
+            if(!next) next = steal(state, index);
+            if(next)
+            {
+                state.nb_pending.fetch_sub(1);
+                next->first(next->second);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock{state.sleep_mutex};
+            state.nb_sleeping.fetch_add(1);
+            state.wake_up.wait(lock, [&state]() { return state.stopping || state.nb_pending.load() > 0; });
+            state.nb_sleeping.fetch_sub(1);
+            if(state.stopping && state.nb_pending.load() == 0) return;
+        }
+    }
+};
+
+} // namespace expected_task
@@ -0,0 +1,151 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/as_completed.hpp>
+
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace
+{
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+using Event = expected_task::backend::task_completion_event<Expected>;
+
+Task makePending(const Event& event)
+{
+    return Task{expected_task::backend::create_task(event)};
+}
+
+Task makeError(std::wstring error)
+{
+    return tl::make_unexpected(std::move(error));
+}
+
+const auto sum = [](const int acc, const int value) { return acc + value; };
+
+} // namespace
+
+TEST_CASE("Test streaming the results of expected_tasks with as_completed", "[as_completed]")
+{
+    SECTION("the results come in the order the tasks finish")
+    {
+        Event first, second;
+        auto stream = as_completed(std::vector<Task>{makePending(first), makePending(second)});
+        auto next = stream.next();
+        CHECK_FALSE(next.is_ready());
+        second.set(Expected{2});
+        CHECK(*next.get() == std::optional{2});
+        first.set(Expected{tl::make_unexpected(L"error"s)});
+        CHECK(stream.next().get().error() == L"error"s);
+        CHECK(*stream.next().get() == std::nullopt);
+    }
+
+    SECTION("ready tasks are streamed right away")
+    {
+        auto stream = as_completed(std::vector<Task>{Task{1}, makeError(L"error"s)});
+        auto first = stream.next();
+        CHECK(first.is_ready());
+        CHECK(*first.get() == std::optional{1});
+        CHECK_FALSE(stream.next().get().has_value());
+        CHECK(*stream.next().get() == std::nullopt);
+    }
+
+    SECTION("a call waiting for the next result gets the end once all the tasks are done")
+    {
+        Event event;
+        auto stream = as_completed(std::vector<Task>{makePending(event)});
+        auto first = stream.next();
+        auto end = stream.next();
+        event.set(Expected{1});
+        CHECK(*first.get() == std::optional{1});
+        CHECK(*end.get() == std::nullopt);
+    }
+
+    SECTION("once the token is cancelled, the results still to come are the cancellation error")
+    {
+        Event event;
+        const pplx::cancellation_token_source source;
+        auto stream = as_completed(std::vector<Task>{makePending(event)}, pplx::task_options{source.get_token()});
+        auto first = stream.next();
+        source.cancel();
+        event.set(Expected{1});
+        CHECK(first.get().error() == L"cancelled"s);
+        CHECK(*stream.next().get() == std::nullopt);
+    }
+}
+
+TEST_CASE("Test folding expected_tasks with fold_async", "[as_completed]")
+{
+    SECTION("the values are folded as the tasks finish")
+    {
+        std::vector<Task> tasks;
+        for(int i = 1; i <= 100; ++i)
+            tasks.push_back(expected_task::create_task([i]() { return i; }));
+        const auto res = fold_async(tasks, 0, sum).get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 5050);
+    }
+
+    SECTION("a lazy range of tasks is folded")
+    {
+        auto tasks = std::views::iota(1, 11) | std::views::transform([](const int i) { return Task{i}; });
+        const auto res = expected_task::fold_async(tasks, 0, sum).get();
+        CHECK(res == Expected{55});
+    }
+
+    SECTION("stop_on_error completes with the first error without waiting")
+    {
+        Event slow;
+        const auto res = fold_async(std::vector<Task>{makePending(slow), makeError(L"error"s), Task{1}}, 0, sum,
+                                    expected_task::stop_on_error{})
+                             .get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error"s);
+        slow.set(Expected{1});
+    }
+
+    SECTION("skip_errors folds the values only")
+    {
+        const auto res = fold_async(std::vector<Task>{Task{1}, makeError(L"error"s), Task{2}}, 0, sum,
+                                    expected_task::skip_errors{})
+                             .get();
+        CHECK(res == Expected{3});
+    }
+
+    SECTION("an aggregator gathers the errors until all the tasks are done")
+    {
+        const auto res = fold_async(std::vector<Task>{makeError(L"error1"s), Task{1}, makeError(L"error2"s)}, 0, sum,
+                                    expected_task::collect_errors{})
+                             .get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == std::vector{L"error1"s, L"error2"s});
+    }
+
+    SECTION("an empty range gives the initial value")
+    {
+        CHECK(fold_async(std::vector<Task>{}, 42, sum).get() == Expected{42});
+    }
+
+    SECTION("an exception thrown by op is forwarded")
+    {
+        const auto res = fold_async(std::vector<Task>{Task{1}}, 0,
+                                    [](int, int) -> int { throw std::runtime_error{"exception"}; });
+        CHECK_THROWS_AS(res.get(), std::runtime_error);
+    }
+
+    SECTION("once the token is cancelled, the next task to finish completes the fold with the cancellation error")
+    {
+        Event event;
+        const pplx::cancellation_token_source source;
+        auto task = fold_async(std::vector<Task>{makePending(event)}, 0, sum, expected_task::stop_on_error{},
+                               pplx::task_options{source.get_token()});
+        source.cancel();
+        event.set(Expected{1});
+        CHECK(std::move(task).get().error() == L"cancelled"s);
+    }
+}
@@ -0,0 +1,125 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/batch_loader.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+using namespace std::string_literals;
+
+namespace
+{
+using Loader = expected_task::batch_loader<int, std::string>;
+using Expected = typename Loader::expected_type;
+
+/**
+ * @brief a batch function answering each key with its text, except the negative ones, and recording the batches.
+ */
+struct RecordingBackend
+{
+    std::mutex mutex;
+    std::vector<std::vector<int>> batches;
+
+    Loader::batch_function function()
+    {
+        return [this](std::vector<int> keys) -> Loader::batch_result_type
+        {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                batches.push_back(keys);
+            }
+            std::vector<Expected> results;
+            for(const int key : keys)
+                results.push_back(key < 0 ? Expected{tl::make_unexpected(L"negative"s)}
+                                          : Expected{std::to_string(key)});
+            return expected_task::create_task([results]() { return results; });
+        };
+    }
+};
+
+} // namespace
+
+TEST_CASE("Test coalescing loads with batch_loader", "[batch_loader]")
+{
+    SECTION("a full batch is sent right away")
+    {
+        RecordingBackend backend;
+        Loader loader{backend.function(), {3, 1h}};
+        auto first = loader.load(1);
+        auto second = loader.load(-2);
+        auto third = loader.load(3);
+        CHECK(*first.get() == "1");
+        CHECK(second.get().error() == L"negative"s);
+        CHECK(*third.get() == "3");
+        CHECK(backend.batches == std::vector<std::vector<int>>{{1, -2, 3}});
+    }
+
+    SECTION("a batch which isn't full is sent once its delay has passed")
+    {
+        RecordingBackend backend;
+        Loader loader{backend.function(), {100, 5ms}};
+        auto first = loader.load(1);
+        auto second = loader.load(2);
+        CHECK(*first.get() == "1");
+        CHECK(*second.get() == "2");
+        CHECK(backend.batches.size() == 1);
+    }
+
+    SECTION("flush sends the keys waiting")
+    {
+        RecordingBackend backend;
+        Loader loader{backend.function(), {100, 1h}};
+        auto first = loader.load(1);
+        loader.flush();
+        CHECK(*first.get() == "1");
+    }
+
+    SECTION("the delay of a batch is a timer of the wheel, cancelled once the batch is sent")
+    {
+        RecordingBackend backend;
+        expected_task::timer_wheel wheel;
+        Loader loader{backend.function(), {100, 1h}, {}, wheel};
+        auto first = loader.load(1);
+        auto second = loader.load(2);
+        CHECK(wheel.size() == 1);
+        loader.flush();
+        CHECK(wheel.size() == 0);
+        CHECK(*first.get() == "1");
+        CHECK(*second.get() == "2");
+        CHECK(backend.batches.size() == 1);
+    }
+
+    SECTION("an error of the whole batch is given to every key")
+    {
+        Loader loader{[](std::vector<int>) -> Loader::batch_result_type { return tl::make_unexpected(L"down"s); },
+                      {2, 1h}};
+        auto first = loader.load(1);
+        auto second = loader.load(2);
+        CHECK(first.get().error() == L"down"s);
+        CHECK(second.get().error() == L"down"s);
+    }
+
+    SECTION("a batch function giving the wrong number of results throws")
+    {
+        Loader loader{[](std::vector<int>) -> Loader::batch_result_type { return std::vector<Expected>{}; }, {1, 1h}};
+        CHECK_THROWS_AS(loader.load(1).get(), std::length_error);
+    }
+
+    SECTION("once the token is cancelled, the loads of the batches finishing get the cancellation error")
+    {
+        using BatchExpected = typename Loader::batch_result_type::expected_type;
+        expected_task::backend::task_completion_event<BatchExpected> event;
+        const pplx::cancellation_token_source source;
+        Loader loader{[&event](std::vector<int>)
+                      { return Loader::batch_result_type{expected_task::backend::create_task(event)}; },
+                      {1, 1h}, pplx::task_options{source.get_token()}};
+        auto first = loader.load(1);
+        source.cancel();
+        event.set(BatchExpected{std::vector{Expected{"1"s}}});
+        CHECK(first.get().error() == L"cancelled"s);
+    }
+}
@@ -0,0 +1,140 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/expected_task.hpp>
+
+#include <string>
+
+using namespace std::string_literals;
+
+namespace
+{
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+using Event = expected_task::backend::task_completion_event<Expected>;
+
+struct Failure
+{
+    int code;
+};
+
+} // namespace
+
+template <> struct expected_task::cancellation_error<Failure>
+{
+    static Failure make()
+    {
+        return Failure{-1};
+    }
+};
+
+TEST_CASE("Test cancelling expected_task chains", "[cancellation]")
+{
+    const pplx::cancellation_token_source source;
+    int nb_stages = 0;
+    const auto count = [&nb_stages](const int value)
+    {
+        ++nb_stages;
+        return value + 1;
+    };
+
+    SECTION("the stages not started yet are skipped once the token is cancelled")
+    {
+        Event event;
+        auto chain = Task{expected_task::backend::create_task(event)}
+                         .with_cancellation(source.get_token())
+                         .then_map(count)
+                         .then_map(count);
+        source.cancel();
+        event.set(Expected{1});
+        const auto res = chain.get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"cancelled"s);
+        CHECK(nb_stages == 0);
+    }
+
+    SECTION("a running stage finishes, and the following ones are skipped")
+    {
+        const auto res = expected_task::create_task([]() { return 1; }, source.get_token())
+                             .then_map(
+                                 [&](const int value)
+                                 {
+                                     source.cancel();
+                                     return count(value);
+                                 })
+                             .then_map(count)
+                             .get();
+        CHECK(res.error() == L"cancelled"s);
+        CHECK(nb_stages == 1);
+    }
+
+    SECTION("create_task doesn't run the function once the token is cancelled")
+    {
+        source.cancel();
+        const auto res = expected_task::create_task(
+                             [&]()
+                             {
+                                 ++nb_stages;
+                                 return 1;
+                             },
+                             source.get_token())
+                             .get();
+        CHECK(res.error() == L"cancelled"s);
+        CHECK(nb_stages == 0);
+    }
+
+    SECTION("stages on a ready result are skipped too")
+    {
+        source.cancel();
+        const auto chain
+            = Task{1}.then_map(count, source.get_token()).and_then([](const int value) { return Expected{value}; });
+        CHECK(chain.is_ready());
+        CHECK(chain.get().error() == L"cancelled"s);
+        CHECK(nb_stages == 0);
+    }
+
+    SECTION("the token of a stage is inherited by the following stages")
+    {
+        Event event;
+        const auto chain
+            = Task{expected_task::backend::create_task(event)}.then_map(count, source.get_token()).then_map(count);
+        event.set(Expected{1});
+        CHECK(*chain.get() == 3);
+        source.cancel();
+        CHECK(chain.then_map(count).get().error() == L"cancelled"s);
+        CHECK(nb_stages == 2);
+    }
+
+    SECTION("error handling stages are skipped as well")
+    {
+        source.cancel();
+        const auto res = Task{tl::make_unexpected(L"error"s)}
+                             .with_cancellation(source.get_token())
+                             .or_else(
+                                 [&](const std::wstring&)
+                                 {
+                                     ++nb_stages;
+                                     return Expected{0};
+                                 })
+                             .get();
+        CHECK(res.error() == L"cancelled"s);
+        CHECK(nb_stages == 0);
+    }
+
+    SECTION("the cancellation error follows the error type of the chain")
+    {
+        source.cancel();
+        const auto res = Task{1}
+                             .with_cancellation(source.get_token())
+                             .map_error([](const std::wstring&) { return Failure{0}; })
+                             .get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error().code == -1);
+    }
+
+    SECTION("a chain which isn't cancelled runs as usual")
+    {
+        const auto res = expected_task::create_task([]() { return 1; }, source.get_token()).then_map(count).get();
+        CHECK(*res == 2);
+        CHECK(nb_stages == 1);
+    }
+}
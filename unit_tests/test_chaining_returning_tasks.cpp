@@ -1,5 +1,7 @@
 #include <catch2/catch.hpp>
 
+#include <chrono>
+#include <future>
 #include <string>
 
 #include "utilities.hpp"
@@ -247,3 +249,64 @@ TEST_CASE("Test expected_task with complex chaining", "[task]")
         }
     }
 }
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+
+Task makeNestedChain(const int depth)
+{
+    auto task = expected_task::create_task([]() { return 1; });
+    if(depth == 0) return task;
+    return task.and_then([depth](const int value)
+                         { return makeNestedChain(depth - 1).then_map([value](const int sum) { return sum + value; }); });
+}
+
+} // namespace
+
+TEST_CASE("Test expected_task chaining does not block the scheduler's threads", "[task]")
+{
+    using namespace std::chrono_literals;
+
+    const auto pool = std::make_shared<Testing::FixedThreadPool>(2);
+    const Testing::ScopedAmbientScheduler scoped_scheduler{pool};
+
+    SECTION("10k nested async stages on a pool of 2 threads")
+    {
+        const int depth = 10000;
+        std::promise<Task::expected_type> promise;
+        auto future = promise.get_future();
+        makeNestedChain(depth).to_task().then([&promise](Task::expected_type res) { promise.set_value(res); });
+
+        REQUIRE(future.wait_for(60s) == std::future_status::ready);
+        const auto res = future.get();
+        REQUIRE(res.has_value());
+        CHECK(*res == depth + 1);
+    }
+
+    SECTION("nested then_map and and_then returning pplx tasks")
+    {
+        std::promise<Task::expected_type> promise;
+        auto future = promise.get_future();
+        Task{1}
+            .and_then(
+                [](const int value)
+                {
+                    return Task{value}
+                        .then_map([](const int v) { return pplx::create_task([v]() { return v + 1; }); })
+                        .and_then(
+                            [](const int v) {
+                                return pplx::create_task([v]() { return Task::expected_type{v * 2}; });
+                            })
+                        .to_task();
+                })
+            .to_task()
+            .then([&promise](Task::expected_type res) { promise.set_value(res); });
+
+        REQUIRE(future.wait_for(60s) == std::future_status::ready);
+        const auto res = future.get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 4);
+    }
+}
@@ -0,0 +1,145 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/coroutine.hpp>
+
+#ifdef EXPECTED_TASK_HAS_COROUTINES
+
+#include <stdexcept>
+#include <string>
+
+using namespace std::string_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+
+Task asyncValue(const int value)
+{
+    return expected_task::create_task([value]() { return value; });
+}
+
+Task asyncError(std::wstring error)
+{
+    return pplx::create_task([error]() -> Task::expected_type { return tl::make_unexpected(error); });
+}
+
+Task addAll(Task t1, Task t2, Task t3)
+{
+    const int v1 = co_await t1;
+    const int v2 = co_await t2;
+    const int v3 = co_await t3;
+    co_return v1 + v2 + v3;
+}
+
+} // namespace
+
+TEST_CASE("Test expected_task with coroutines", "[coroutine]")
+{
+
+    SECTION("co_return a value")
+    {
+        const auto res = []() -> Task { co_return 3; }().get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 3);
+    }
+
+    SECTION("co_return an error")
+    {
+        const auto res = []() -> Task { co_return tl::make_unexpected(L"nope"s); }().get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"nope");
+    }
+
+    SECTION("co_await asynchronous and ready expected_tasks")
+    {
+        const auto res = addAll(asyncValue(1), Task{2}, asyncValue(3)).get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 6);
+    }
+
+    SECTION("an error short-circuits the coroutine")
+    {
+        std::size_t has_been_called = 0;
+        const auto res = [&has_been_called]() -> Task
+        {
+            const int value = co_await asyncValue(1);
+            has_been_called++;
+            co_await asyncError(L"error!");
+            has_been_called++;
+            co_return value;
+        }().get();
+        CHECK(has_been_called == 1);
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error!");
+    }
+
+    SECTION("a ready error short-circuits the coroutine")
+    {
+        std::size_t has_been_called = 0;
+        const auto res = [&has_been_called]() -> Task
+        {
+            co_await Task{tl::make_unexpected(L"error!"s)};
+            has_been_called++;
+            co_return 1;
+        }().get();
+        CHECK(has_been_called == 0);
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error!");
+    }
+
+    SECTION("co_await the underlying task gives the whole tl::expected")
+    {
+        const auto res = []() -> Task
+        {
+            const auto exp = co_await asyncError(L"error!").to_task();
+            co_return exp.has_value() ? 0 : static_cast<int>(exp.error().size());
+        }().get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 6);
+    }
+
+    SECTION("co_await a simple pplx::task")
+    {
+        const auto res = []() -> expected_task::expected_task<std::wstring, std::wstring>
+        {
+            const int value = co_await pplx::create_task([]() { return 2; });
+            co_return std::to_wstring(value);
+        }().get();
+        REQUIRE(res.has_value());
+        CHECK(*res == L"2");
+    }
+
+    SECTION("coroutines with a void value")
+    {
+        std::size_t has_been_called = 0;
+        const auto res = [&has_been_called]() -> expected_task::expected_task<void, std::wstring>
+        {
+            co_await expected_task::create_task([&has_been_called]() { has_been_called++; });
+            co_await asyncValue(2);
+        }().get();
+        CHECK(has_been_called == 1);
+        CHECK(res.has_value());
+    }
+
+    SECTION("exceptions are forwarded to the task")
+    {
+        auto task = []() -> Task
+        {
+            co_await asyncValue(1);
+            throw std::runtime_error{"boom"};
+        }();
+        CHECK_THROWS_AS(task.get(), std::runtime_error);
+    }
+
+    SECTION("coroutines can be chained like any other expected_task")
+    {
+        const auto res = addAll(asyncValue(1), asyncValue(2), asyncValue(3))
+                             .then_map([](const int value) { return value * 2; })
+                             .get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 12);
+    }
+}
+
+#endif
@@ -0,0 +1,217 @@
+#include <catch2/catch.hpp>
+
+#include "utilities.hpp"
+
+#include <expected_task/when_all.hpp>
+#include <expected_task/work_stealing_executor.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<int, std::wstring>;
+
+/**
+ * @brief jobs scheduled from a worker of the executor, recording the highest count of pending jobs they see.
+ */
+struct Stress
+{
+    static constexpr std::size_t nb_jobs = 10000;
+
+    std::shared_ptr<expected_task::work_stealing_executor> executor;
+    std::atomic<std::size_t> max_pending{0};
+    std::atomic<std::size_t> nb_done{0};
+    std::promise<void> done;
+
+    static void schedule(void* param)
+    {
+        auto& stress = *static_cast<Stress*>(param);
+        for(std::size_t i = 0; i < nb_jobs; ++i)
+            stress.executor->schedule(&Stress::run, param);
+    }
+
+    static void run(void* param)
+    {
+        auto& stress = *static_cast<Stress*>(param);
+        const auto pending = stress.executor->nb_pending();
+        auto max_pending = stress.max_pending.load();
+        while(pending > max_pending && !stress.max_pending.compare_exchange_weak(max_pending, pending))
+            ;
+        if(stress.nb_done.fetch_add(1) + 1 == nb_jobs) stress.done.set_value();
+    }
+};
+
+} // namespace
+
+TEST_CASE("Test expected_task on a given scheduler", "[executor]")
+{
+    const auto executor = std::make_shared<expected_task::work_stealing_executor>(2);
+
+    SECTION("create_task and the following stages run on the executor")
+    {
+        const auto res = expected_task::create_task(
+                             [&executor]()
+                             {
+                                 CHECK(executor->owns_current_thread());
+                                 return 1;
+                             },
+                             executor)
+                             .then_map(
+                                 [&executor](const int value)
+                                 {
+                                     CHECK(executor->owns_current_thread());
+                                     return value + 1;
+                                 })
+                             .and_then(
+                                 [&executor](const int value) -> Task::expected_type
+                                 {
+                                     CHECK(executor->owns_current_thread());
+                                     return value * 2;
+                                 })
+                             .get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 4);
+    }
+
+    SECTION("a stage given a scheduler runs on it, even on a ready result")
+    {
+        const auto res = Task{1}
+                             .then_map(
+                                 [&executor](const int value)
+                                 {
+                                     CHECK(executor->owns_current_thread());
+                                     return value + 1;
+                                 },
+                                 executor)
+                             .get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 2);
+    }
+
+    SECTION("schedule_on moves the following stages onto the scheduler")
+    {
+        const auto res = Task{tl::make_unexpected(L"error"s)}
+                             .schedule_on(executor)
+                             .or_else(
+                                 [&executor](std::wstring) -> Task::expected_type
+                                 {
+                                     CHECK(executor->owns_current_thread());
+                                     return 3;
+                                 })
+                             .get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 3);
+    }
+
+    SECTION("when_all on a scheduler")
+    {
+        std::vector<Task> tasks;
+        for(int i = 0; i < 100; ++i)
+            tasks.push_back(expected_task::create_task([i]() { return i; }, executor));
+        const auto res = when_all(tasks, executor)
+                             .then_map(
+                                 [&executor](const std::vector<int>& values)
+                                 {
+                                     CHECK(executor->owns_current_thread());
+                                     return values.size();
+                                 })
+                             .get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 100);
+    }
+}
+
+TEST_CASE("Test the work stealing executor", "[executor]")
+{
+    SECTION("jobs scheduled from the workers and from other threads all run")
+    {
+        const auto executor = std::make_shared<expected_task::work_stealing_executor>(4);
+        std::vector<Task> tasks;
+        for(int i = 0; i < 200; ++i)
+            tasks.push_back(expected_task::create_task([i]() { return i; }, executor)
+                                .and_then([](const int value)
+                                          { return expected_task::create_task([value]() { return value; }); }));
+        const auto res = when_all(tasks).get();
+        REQUIRE(res.has_value());
+        CHECK(res->size() == 200);
+        CHECK(res->back() == 199);
+    }
+
+    SECTION("the jobs scheduled from a worker are never counted below zero")
+    {
+        Stress stress{std::make_shared<expected_task::work_stealing_executor>(4)};
+        auto done = stress.done.get_future();
+        // the jobs are scheduled from a worker, where the others can take them as soon as they are pushed
+        stress.executor->schedule(&Stress::schedule, &stress);
+        done.wait();
+        // joins the workers before the rest of stress goes away
+        stress.executor.reset();
+        CHECK(stress.max_pending <= Stress::nb_jobs);
+        CHECK(stress.nb_done == Stress::nb_jobs);
+    }
+
+    SECTION("an idle worker steals the jobs of a busy one")
+    {
+        const auto executor = std::make_shared<expected_task::work_stealing_executor>(2);
+        // the first job schedules the second one on its own worker, and then waits for it
+        const auto res = expected_task::create_task(
+                             [&executor]()
+                             {
+                                 return expected_task::create_task([]() { return 2; }, executor).get();
+                             },
+                             executor)
+                             .get();
+        REQUIRE(res.has_value());
+        REQUIRE(res->has_value());
+        CHECK(**res == 2);
+    }
+
+    SECTION("destroying the executor runs the remaining jobs")
+    {
+        std::atomic<std::size_t> has_been_called{0};
+        {
+            auto executor = std::make_shared<expected_task::work_stealing_executor>(1);
+            for(std::size_t i = 0; i < 100; ++i)
+                executor->schedule([](void* param) { static_cast<std::atomic<std::size_t>*>(param)->fetch_add(1); },
+                                   &has_been_called);
+        }
+        CHECK(has_been_called == 100);
+    }
+
+    SECTION("the last reference to the executor can be released by one of its own jobs")
+    {
+        struct Release
+        {
+            std::shared_ptr<expected_task::work_stealing_executor> executor;
+            std::promise<void> released;
+        };
+        auto release = std::make_unique<Release>();
+        auto released = release->released.get_future();
+        {
+            auto executor = std::make_shared<expected_task::work_stealing_executor>(2);
+            release->executor = executor;
+        }
+        auto& executor = *release->executor;
+        executor.schedule(
+            [](void* param)
+            {
+                auto* release = static_cast<Release*>(param);
+                release->executor.reset();
+                release->released.set_value();
+            },
+            release.get());
+        released.wait();
+        CHECK(release->executor == nullptr);
+        // the worker which destroyed the executor goes back to its loop, and must not touch the executor anymore
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+}
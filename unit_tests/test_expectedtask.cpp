@@ -1,6 +1,8 @@
 #include <catch2/catch.hpp>
 
+#include <stdexcept>
 #include <string>
+#include <thread>
 
 #include "utilities.hpp"
 
@@ -255,6 +257,77 @@ TEST_CASE("Test expected_task", "[task]")
         REQUIRE(error_lmbd_has_been_called == 1);
     }
 
+    SECTION("or_else with tasks")
+    {
+        const std::wstring error = L"error!";
+        using Task = expected_task::expected_task<double, std::wstring>;
+
+        SECTION("recovering with a pplx::task<expected>")
+        {
+            std::size_t or_else_lmbd_has_been_called = 0;
+            const auto res = Task{tl::make_unexpected(error)}
+                                 .or_else(
+                                     [&or_else_lmbd_has_been_called](std::wstring) -> pplx::task<Task::expected_type>
+                                     {
+                                         or_else_lmbd_has_been_called++;
+                                         return pplx::create_task([]() { return Task::expected_type{4.2}; });
+                                     })
+                                 .get();
+            REQUIRE(or_else_lmbd_has_been_called == 1);
+            REQUIRE(res.has_value());
+            CHECK(*res == 4.2);
+        }
+
+        SECTION("recovering with an expected_task")
+        {
+            std::size_t or_else_lmbd_has_been_called = 0;
+            const auto res = Task{tl::make_unexpected(error)}
+                                 .or_else(
+                                     [&or_else_lmbd_has_been_called, &error](const std::wstring& err) -> Task
+                                     {
+                                         or_else_lmbd_has_been_called++;
+                                         CHECK(err == error);
+                                         return tl::make_unexpected(L"new " + err);
+                                     })
+                                 .get();
+            REQUIRE(or_else_lmbd_has_been_called == 1);
+            REQUIRE_FALSE(res.has_value());
+            CHECK(res.error() == L"new " + error);
+        }
+
+        SECTION("with a pplx::task<void> keeps the error")
+        {
+            std::size_t or_else_lmbd_has_been_called = 0;
+            const auto res = Task{tl::make_unexpected(error)}
+                                 .or_else(
+                                     [&or_else_lmbd_has_been_called](std::wstring)
+                                     {
+                                         return pplx::create_task([&or_else_lmbd_has_been_called]()
+                                                                  { or_else_lmbd_has_been_called++; });
+                                     })
+                                 .get();
+            REQUIRE(or_else_lmbd_has_been_called == 1);
+            REQUIRE_FALSE(res.has_value());
+            CHECK(res.error() == error);
+        }
+
+        SECTION("with a value")
+        {
+            std::size_t or_else_lmbd_has_been_called = 0;
+            const auto res = Task{1.2}
+                                 .or_else(
+                                     [&or_else_lmbd_has_been_called](std::wstring) -> Task
+                                     {
+                                         or_else_lmbd_has_been_called++;
+                                         return 4.2;
+                                     })
+                                 .get();
+            REQUIRE(or_else_lmbd_has_been_called == 0);
+            REQUIRE(res.has_value());
+            CHECK(*res == 1.2);
+        }
+    }
+
     SECTION("basic map_error usage")
     {
 
@@ -402,3 +475,149 @@ TEST_CASE("Test expected_task", "[task]")
         }
     }
 }
+
+TEST_CASE("Test expected_task with an already known result", "[task][ready]")
+{
+    using Task = expected_task::expected_task<double, std::wstring>;
+
+    SECTION("a synchronous chain runs inline and stays ready")
+    {
+        const auto caller = std::this_thread::get_id();
+        std::size_t has_been_called = 0;
+        const auto task = Task{1.5}
+                              .then_map(
+                                  [&has_been_called, caller](const double value)
+                                  {
+                                      CHECK(std::this_thread::get_id() == caller);
+                                      has_been_called++;
+                                      return 2 * value;
+                                  })
+                              .and_then(Testing::makeFailableTimesTwoLambda(has_been_called))
+                              .map_error([](std::wstring error) { return error + L"!"; });
+        CHECK(has_been_called == 2);
+        CHECK(task.is_ready());
+        CHECK(task.wait() == pplx::completed);
+        const auto res = task.get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 6.);
+    }
+
+    SECTION("a ready error skips the value callbacks")
+    {
+        std::size_t has_been_called = 0;
+        const auto task = Task{tl::make_unexpected(L"error"s)}
+                              .then_map([&has_been_called](const double value)
+                                        {
+                                            has_been_called++;
+                                            return value;
+                                        })
+                              .or_else([](std::wstring) -> Task::expected_type { return 3.; });
+        CHECK(has_been_called == 0);
+        REQUIRE(task.is_ready());
+        CHECK(*task.get() == 3.);
+    }
+
+    SECTION("an asynchronous stage ends the ready state")
+    {
+        std::size_t has_been_called = 0;
+        const auto task = Task{1.}.then_map(Testing::makeTimesTwoLambda(has_been_called)).then_map([](const double value)
+                                                                                                 { return value + 1; });
+        const auto res = task.get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 3.);
+        CHECK(has_been_called == 1);
+        CHECK(Task{pplx::task_from_result(1.)}.is_ready() == false);
+    }
+
+    SECTION("exceptions thrown inline are forwarded to the task")
+    {
+        const auto task = Task{1.}.then_map([](double) -> double { throw std::runtime_error{"boom"}; });
+        CHECK_FALSE(task.is_ready());
+        CHECK_THROWS_AS(task.get(), std::runtime_error);
+    }
+}
+
+TEST_CASE("Test expected_task errors skip the success-only stages", "[task][short-circuit]")
+{
+    using Task = expected_task::expected_task<double, std::wstring>;
+    const auto pool = std::make_shared<Testing::FixedThreadPool>(2);
+    const Testing::ScopedAmbientScheduler scoped_scheduler{pool};
+    const auto failing = []() -> Task
+    { return pplx::create_task([]() -> Task::expected_type { return tl::make_unexpected(L"error"s); }); };
+
+    SECTION("stages following an error are not scheduled")
+    {
+        std::size_t has_been_called = 0;
+        auto task = failing().then_map(Testing::makeTimesTwoLambda(has_been_called));
+        for(std::size_t i = 0; i < 20; ++i)
+            task = task.and_then(Testing::makeFailableTimesTwoLambda(has_been_called))
+                       .then_map([&has_been_called](const double value)
+                                 {
+                                     has_been_called++;
+                                     return value;
+                                 });
+        const auto res = task.or_else([](std::wstring error) -> Task::expected_type
+                                      { return tl::make_unexpected(error + L"!"); })
+                             .get();
+        CHECK(has_been_called == 0);
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error!");
+        // the failing task, the first stage seeing the error and or_else
+        CHECK(pool->scheduledCount() <= 3);
+    }
+
+    SECTION("an error returned by a stage is short-circuited too")
+    {
+        std::size_t has_been_called = 0;
+        const auto task = Task{pplx::task_from_result(1.)}
+                              .and_then(Testing::makeFailLambda<double, std::wstring>(has_been_called, L"error"s))
+                              .then_map([&has_been_called](const double value)
+                                        {
+                                            has_been_called++;
+                                            return value;
+                                        });
+        CHECK(task.wait() == pplx::completed);
+        const auto res = task.get();
+        CHECK(has_been_called == 1);
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error");
+    }
+
+    SECTION("a short-circuited error reaches every consumer")
+    {
+        std::size_t has_been_called = 0;
+        auto task = failing().then_map(Testing::makeTimesTwoLambda(has_been_called));
+        const auto mapped = task.map_error([](const std::wstring& error) { return error.size(); }).get();
+        const auto value = task.then_return_value_or_convert_error_to_value([](std::wstring) { return 3.; }).get();
+        const auto exp = task.to_task().get();
+        CHECK(has_been_called == 0);
+        REQUIRE_FALSE(mapped.has_value());
+        CHECK(mapped.error() == 5);
+        CHECK(value == 3.);
+        REQUIRE_FALSE(exp.has_value());
+        CHECK(exp.error() == L"error");
+    }
+
+    SECTION("then gets the short-circuited error as an unexpected")
+    {
+        const auto res = failing()
+                             .then_map([](const double value) { return value; })
+                             .then([](Task::expected_type exp) { return exp.has_value(); })
+                             .get();
+        CHECK_FALSE(res);
+    }
+
+    SECTION("a chain dropped before its error is known has it observed, and its copies too")
+    {
+        pplx::task_completion_event<Task::expected_type> event;
+        std::size_t has_been_called = 0;
+        {
+            const auto dropped = Task{pplx::create_task(event)}.then_map(Testing::makeTimesTwoLambda(has_been_called));
+            const auto copy = dropped;
+        }
+        event.set(tl::make_unexpected(L"error"s));
+        // pplx would report the error of the dropped chain as an unobserved exception once its tasks are destroyed
+        CHECK(Task{pplx::create_task(event)}.get().error() == L"error");
+        CHECK(has_been_called == 0);
+    }
+}
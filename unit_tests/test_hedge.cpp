@@ -0,0 +1,260 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/hedge.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using namespace std::string_literals;
+
+namespace
+{
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+using Event = expected_task::backend::task_completion_event<Expected>;
+
+/**
+ * @brief attempts which stay pending until they are completed by the test.
+ */
+class PendingAttempts
+{
+public:
+    Task operator()(const pplx::cancellation_token& token)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_events.emplace_back();
+        m_tokens.push_back(token);
+        return Task{expected_task::backend::create_task(m_events.back())};
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        return m_events.size();
+    }
+
+    void waitFor(const std::size_t nb_attempts) const
+    {
+        while(size() < nb_attempts)
+            std::this_thread::sleep_for(1ms);
+    }
+
+    void complete(const std::size_t index, Expected res)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_events[index].set(std::move(res));
+    }
+
+    bool isCancelled(const std::size_t index) const
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        return m_tokens[index].is_canceled();
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<Event> m_events;
+    std::vector<pplx::cancellation_token> m_tokens;
+};
+
+} // namespace
+
+TEST_CASE("Test hedging expected_tasks with hedge", "[hedge]")
+{
+    expected_task::timer_wheel wheel;
+    PendingAttempts attempts;
+    const auto factory = [&attempts](const pplx::cancellation_token& token) { return attempts(token); };
+
+    SECTION("an attempt done before the delay sends no hedge")
+    {
+        expected_task::hedge_policy policy{1h};
+        auto hedged = expected_task::hedge(factory, policy, 2, {}, wheel);
+        attempts.waitFor(1);
+        attempts.complete(0, Expected{1});
+        CHECK(hedged.get() == Expected{1});
+        CHECK(attempts.size() == 1);
+        CHECK(wheel.size() == 0);
+        const auto statistics = policy.statistics();
+        CHECK(statistics.calls == 1);
+        CHECK(statistics.hedges == 0);
+        CHECK(statistics.hedge_wins == 0);
+    }
+
+    SECTION("a slow attempt is hedged, and the first attempt to finish wins")
+    {
+        expected_task::hedge_policy policy{5ms};
+        auto hedged = expected_task::hedge(factory, policy, 1, {}, wheel);
+        attempts.waitFor(2);
+        attempts.complete(1, Expected{2});
+        CHECK(hedged.get() == Expected{2});
+        CHECK(attempts.isCancelled(0));
+        attempts.complete(0, Expected{1});
+        const auto statistics = policy.statistics();
+        CHECK(statistics.calls == 1);
+        CHECK(statistics.hedges == 1);
+        CHECK(statistics.hedge_wins == 1);
+    }
+
+    SECTION("the first attempt can win after hedges were sent")
+    {
+        expected_task::hedge_policy policy{1ms};
+        auto hedged = expected_task::hedge(factory, policy, 1, {}, wheel);
+        attempts.waitFor(2);
+        attempts.complete(0, Expected{tl::make_unexpected(L"error"s)});
+        CHECK(hedged.get().error() == L"error"s);
+        CHECK(attempts.isCancelled(1));
+        CHECK(policy.statistics().hedge_wins == 0);
+    }
+
+    SECTION("no more than max_hedges copies are sent")
+    {
+        expected_task::hedge_policy policy{1ms};
+        auto hedged = expected_task::hedge(factory, policy, 3, {}, wheel);
+        attempts.waitFor(4);
+        std::this_thread::sleep_for(20ms);
+        CHECK(attempts.size() == 4);
+        CHECK(wheel.size() == 0);
+        attempts.complete(3, Expected{4});
+        CHECK(hedged.get() == Expected{4});
+        CHECK(policy.statistics().hedges == 3);
+    }
+
+    SECTION("the losers skip their stages left")
+    {
+        std::atomic<int> nb_stages{0};
+        auto hedged = expected_task::hedge(
+            [&](const pplx::cancellation_token& token)
+            {
+                return attempts(token).with_cancellation(token).then_map(
+                    [&nb_stages](const int value)
+                    {
+                        ++nb_stages;
+                        return value;
+                    });
+            },
+            1ms, 1, {}, wheel);
+        attempts.waitFor(2);
+        attempts.complete(1, Expected{2});
+        CHECK(hedged.get() == Expected{2});
+        attempts.complete(0, Expected{1});
+        CHECK(nb_stages == 1);
+    }
+
+    SECTION("a factory without token is supported, and its ready results are given right away")
+    {
+        int nb_calls = 0;
+        const auto res = expected_task::hedge(
+                             [&nb_calls]()
+                             {
+                                 ++nb_calls;
+                                 return Task{3};
+                             },
+                             1ms, 2, {}, wheel)
+                             .get();
+        CHECK(res == Expected{3});
+        CHECK(nb_calls == 1);
+        CHECK(wheel.size() == 0);
+    }
+
+    SECTION("exceptions thrown by the factory are forwarded")
+    {
+        auto hedged = expected_task::hedge([]() -> Task { throw std::runtime_error{"factory"}; }, 1ms, 1, {}, wheel);
+        CHECK_THROWS_AS(hedged.get(), std::runtime_error);
+    }
+}
+
+TEST_CASE("Test cancelling a hedged call", "[hedge]")
+{
+    expected_task::timer_wheel wheel;
+    PendingAttempts attempts;
+    const auto factory = [&attempts](const pplx::cancellation_token& token) { return attempts(token); };
+    const pplx::cancellation_token_source source;
+
+    SECTION("the attempts are cancelled along with the call, which finishes with the cancellation error")
+    {
+        auto hedged = expected_task::hedge(factory, 1h, 1, pplx::task_options{source.get_token()}, wheel);
+        attempts.waitFor(1);
+        source.cancel();
+        CHECK(attempts.isCancelled(0));
+        attempts.complete(0, Expected{1});
+        CHECK(hedged.get().error() == L"cancelled"s);
+        CHECK(wheel.size() == 0);
+    }
+
+    SECTION("no hedge is sent once the call is cancelled")
+    {
+        expected_task::hedge_policy policy{20ms};
+        auto hedged = expected_task::hedge(factory, policy, 2, pplx::task_options{source.get_token()}, wheel);
+        attempts.waitFor(1);
+        source.cancel();
+        CHECK(hedged.get().error() == L"cancelled"s);
+        CHECK(attempts.size() == 1);
+        CHECK(policy.statistics().hedges == 0);
+        attempts.complete(0, Expected{1});
+    }
+
+    SECTION("a call cancelled beforehand makes no attempt")
+    {
+        source.cancel();
+        CHECK(expected_task::hedge(factory, 1ms, 1, pplx::task_options{source.get_token()}, wheel).get().error()
+              == L"cancelled"s);
+        CHECK(attempts.size() == 0);
+    }
+}
+
+TEST_CASE("Test the delays of hedge_policy", "[hedge]")
+{
+    SECTION("a fixed policy keeps its delay")
+    {
+        expected_task::hedge_policy policy{7ms};
+        policy.record(1s);
+        CHECK(policy.delay() == 7ms);
+    }
+
+    SECTION("an adaptive policy uses its initial delay until it has enough samples")
+    {
+        auto policy = expected_task::hedge_policy::adaptive(0.95, 10ms, 20);
+        for(int i = 0; i < 19; ++i)
+            policy.record(1ms);
+        CHECK(policy.delay() == 10ms);
+        policy.record(1ms);
+        CHECK(policy.delay() < 2ms);
+    }
+
+    SECTION("an adaptive policy waits for the percentile of the latencies")
+    {
+        auto policy = expected_task::hedge_policy::adaptive(0.95);
+        for(int i = 1; i <= 100; ++i)
+            policy.record(std::chrono::milliseconds{i});
+        CHECK(policy.delay() >= 95ms);
+        CHECK(policy.delay() <= 105ms);
+    }
+
+    SECTION("an adaptive policy follows the latency as it changes")
+    {
+        auto policy = expected_task::hedge_policy::adaptive(0.95, 10ms, 20, 100);
+        for(int i = 0; i < 100; ++i)
+            policy.record(50ms);
+        CHECK(policy.delay() >= 50ms);
+        for(int i = 0; i < 500; ++i)
+            policy.record(1ms);
+        CHECK(policy.delay() < 2ms);
+    }
+
+    SECTION("an adaptive policy halves its counts once every window samples, not more often")
+    {
+        auto policy = expected_task::hedge_policy::adaptive(0.7, 10ms, 20, 100);
+        for(int i = 0; i < 100; ++i)
+            policy.record(50ms);
+        // halved to 50 samples of 50 ms, which are a third of the ones recorded until the next halving
+        for(int i = 0; i < 99; ++i)
+            policy.record(1ms);
+        CHECK(policy.delay() >= 50ms);
+    }
+}
@@ -0,0 +1,229 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/loop.hpp>
+
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace
+{
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+using VoidTask = expected_task::expected_task<void, std::wstring>;
+
+struct Page
+{
+    int index = 0;
+    int total = 0;
+};
+
+using PageTask = expected_task::expected_task<Page, std::wstring>;
+
+} // namespace
+
+TEST_CASE("Test looping over expected_tasks with while_async", "[loop]")
+{
+    SECTION("the body runs as long as the condition holds, on the state it returns")
+    {
+        const auto res = expected_task::while_async(
+                             Page{}, [](const Page& page) { return page.index < 10; },
+                             [](Page page)
+                             {
+                                 return expected_task::create_task(
+                                     [page]() { return Page{page.index + 1, page.total + page.index}; });
+                             })
+                             .get();
+        REQUIRE(res.has_value());
+        CHECK(res->index == 10);
+        CHECK(res->total == 45);
+    }
+
+    SECTION("the body isn't called if the condition doesn't hold")
+    {
+        int nb_calls = 0;
+        const auto res = expected_task::while_async(
+                             Page{3, 7}, [](const Page&) { return false; },
+                             [&nb_calls](Page page)
+                             {
+                                 ++nb_calls;
+                                 return PageTask{page};
+                             })
+                             .get();
+        CHECK(res->total == 7);
+        CHECK(nb_calls == 0);
+    }
+
+    SECTION("a million iterations done right away don't grow the stack")
+    {
+        const auto res = expected_task::while_async(
+                             0, [](const int i) { return i < 1000000; }, [](const int i) { return Task{i + 1}; })
+                             .get();
+        CHECK(res == Expected{1000000});
+    }
+
+    SECTION("iterations alternating between ready and asynchronous ones")
+    {
+        const auto res = expected_task::while_async(
+                             0, [](const int i) { return i < 10000; },
+                             [](const int i)
+                             {
+                                 if(i % 2 == 0) return Task{i + 1};
+                                 return expected_task::create_task([i]() { return i + 1; });
+                             })
+                             .get();
+        CHECK(res == Expected{10000});
+    }
+
+    SECTION("the first error stops the loop")
+    {
+        int nb_calls = 0;
+        const auto res = expected_task::while_async(
+                             0, [](const int) { return true; },
+                             [&nb_calls](const int i) -> Task
+                             {
+                                 ++nb_calls;
+                                 if(i == 5) return tl::make_unexpected(L"page 5"s);
+                                 return expected_task::create_task([i]() { return i + 1; });
+                             })
+                             .get();
+        CHECK(res.error() == L"page 5"s);
+        CHECK(nb_calls == 6);
+    }
+
+    SECTION("exceptions are forwarded")
+    {
+        auto loop = expected_task::while_async(
+            0, [](const int) { return true; },
+            [](const int i) -> Task
+            {
+                if(i == 3) throw std::runtime_error{"body"};
+                return Task{i + 1};
+            });
+        CHECK_THROWS_AS(loop.get(), std::runtime_error);
+    }
+
+    SECTION("no other iteration is started once the token is cancelled")
+    {
+        const pplx::cancellation_token_source source;
+        const auto res = expected_task::while_async(
+                             0, [](const int) { return true; },
+                             [&source](const int i)
+                             {
+                                 if(i == 3) source.cancel();
+                                 return expected_task::create_task([i]() { return i + 1; });
+                             },
+                             pplx::task_options{source.get_token()})
+                             .get();
+        CHECK(res.error() == L"cancelled"s);
+    }
+}
+
+TEST_CASE("Test polling expected_tasks with repeat_until", "[loop]")
+{
+    int nb_calls = 0;
+    const auto poll = [&nb_calls]()
+    {
+        const auto call = ++nb_calls;
+        return expected_task::create_task([call]() { return call; });
+    };
+
+    SECTION("the body runs until its value satisfies the predicate")
+    {
+        const auto res = expected_task::repeat_until(poll, [](const int value) { return value >= 4; }).get();
+        CHECK(res == Expected{4});
+        CHECK(nb_calls == 4);
+    }
+
+    SECTION("the body always runs once")
+    {
+        const auto res = expected_task::repeat_until(poll, [](const int) { return true; }).get();
+        CHECK(res == Expected{1});
+    }
+
+    SECTION("errors stop the polling")
+    {
+        const auto res
+            = expected_task::repeat_until([]() { return Task{tl::make_unexpected(L"down"s)}; }, [](const int)
+                                          { return false; })
+                  .get();
+        CHECK(res.error() == L"down"s);
+    }
+}
+
+TEST_CASE("Test running expected_tasks one after the other with for_each_sequential", "[loop]")
+{
+    std::vector<int> visited;
+
+    SECTION("the inputs are visited in order, each once the previous task is done")
+    {
+        const auto res = expected_task::for_each_sequential(std::vector{1, 2, 3, 4},
+                                                            [&visited](const int i)
+                                                            {
+                                                                return expected_task::create_task(
+                                                                    [&visited, i]() { visited.push_back(i); });
+                                                            })
+                             .get();
+        CHECK(res.has_value());
+        CHECK(visited == std::vector{1, 2, 3, 4});
+    }
+
+    SECTION("the first error stops the loop, without going through the inputs left")
+    {
+        const auto res = expected_task::for_each_sequential(std::views::iota(0),
+                                                            [&visited](const int i) -> Task
+                                                            {
+                                                                visited.push_back(i);
+                                                                if(i == 2) return tl::make_unexpected(L"two"s);
+                                                                return Task{i};
+                                                            })
+                             .get();
+        CHECK(res.error() == L"two"s);
+        CHECK(visited == std::vector{0, 1, 2});
+    }
+
+    SECTION("an empty range completes right away")
+    {
+        const auto res
+            = expected_task::for_each_sequential(std::vector<int>{}, [](const int) { return VoidTask{}; }).get();
+        CHECK(res.has_value());
+    }
+
+    SECTION("the elements of an rvalue range are moved into the function")
+    {
+        std::vector<std::unique_ptr<int>> inputs;
+        for(int i = 0; i < 3; ++i)
+            inputs.push_back(std::make_unique<int>(i));
+        const auto res = expected_task::for_each_sequential(std::move(inputs),
+                                                            [&visited](std::unique_ptr<int> input)
+                                                            {
+                                                                visited.push_back(*input);
+                                                                return Task{*input};
+                                                            })
+                             .get();
+        CHECK(res.has_value());
+        CHECK(visited == std::vector{0, 1, 2});
+    }
+
+    SECTION("the elements of a view over an lvalue container are copied, and left intact")
+    {
+        const auto payload = std::string(64, 'x');
+        std::vector<std::string> inputs{payload, payload};
+        std::size_t size = 0;
+        const auto res = expected_task::for_each_sequential(inputs | std::views::filter([](const std::string&)
+                                                                                        { return true; }),
+                                                            [&size](std::string input)
+                                                            {
+                                                                size += input.size();
+                                                                return VoidTask{tl::expected<void, std::wstring>{}};
+                                                            })
+                             .get();
+        CHECK(res.has_value());
+        CHECK(size == 128);
+        CHECK(inputs == std::vector{payload, payload});
+    }
+}
@@ -0,0 +1,131 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/memoized.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using namespace std::string_literals;
+
+namespace
+{
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+using Event = expected_task::backend::task_completion_event<Expected>;
+using Memoized = expected_task::memoized<int, int>;
+
+} // namespace
+
+TEST_CASE("Test sharing and caching calls with memoized", "[memoized]")
+{
+    std::atomic<int> nb_calls{0};
+
+    SECTION("concurrent callers of the same key share a single call")
+    {
+        Event event;
+        Memoized memoized{[&](const int) {
+            ++nb_calls;
+            return Task{expected_task::backend::create_task(event)};
+        }};
+        auto first = memoized(1);
+        auto second = memoized(1);
+        event.set(Expected{42});
+        CHECK(*first.get() == 42);
+        CHECK(*second.get() == 42);
+        CHECK(nb_calls == 1);
+        CHECK(memoized.statistics().joins == 1);
+    }
+
+    SECTION("a cached result is given back right away")
+    {
+        Memoized memoized{[&](const int key) {
+            ++nb_calls;
+            return expected_task::create_task([key]() { return key * 2; });
+        }};
+        CHECK(*memoized(2).get() == 4);
+        const auto cached = memoized(2);
+        CHECK(cached.is_ready());
+        CHECK(*cached.get() == 4);
+        CHECK(*memoized(3).get() == 6);
+        CHECK(nb_calls == 2);
+        CHECK(memoized.statistics().hits == 1);
+        CHECK(memoized.statistics().misses == 2);
+    }
+
+    SECTION("errors are kept for error_ttl only")
+    {
+        Memoized memoized{[&](const int) {
+                              ++nb_calls;
+                              return Task{tl::make_unexpected(L"error"s)};
+                          },
+                          {100, 1h, 200ms}};
+        CHECK_FALSE(memoized(1).get().has_value());
+        CHECK_FALSE(memoized(1).get().has_value());
+        CHECK(nb_calls == 1);
+        std::this_thread::sleep_for(300ms);
+        CHECK_FALSE(memoized(1).get().has_value());
+        CHECK(nb_calls == 2);
+    }
+
+    SECTION("the least recently used keys are evicted beyond the capacity")
+    {
+        Memoized memoized{[&](const int key) {
+                              ++nb_calls;
+                              return Task{key};
+                          },
+                          {2, 1h, 1h, 1}};
+        memoized(1).get();
+        memoized(2).get();
+        memoized(1).get();
+        memoized(3).get();
+        CHECK(nb_calls == 3);
+        memoized(1).get();
+        CHECK(nb_calls == 3);
+        memoized(2).get();
+        CHECK(nb_calls == 4);
+    }
+
+    SECTION("calls in flight are never evicted, even beyond the capacity")
+    {
+        Event first, second;
+        Memoized memoized{[&](const int key) {
+                              ++nb_calls;
+                              return Task{expected_task::backend::create_task(key == 1 ? first : second)};
+                          },
+                          {1, 1h, 1h, 1}};
+        auto calls = std::vector{memoized(1), memoized(2), memoized(1), memoized(2)};
+        CHECK(nb_calls == 2);
+        first.set(Expected{1});
+        second.set(Expected{2});
+        CHECK(*calls[2].get() == 1);
+        CHECK(*calls[3].get() == 2);
+        CHECK(memoized.statistics().joins == 2);
+    }
+
+    SECTION("an invalidated key is called again")
+    {
+        Memoized memoized{[&](const int key) {
+            ++nb_calls;
+            return Task{key};
+        }};
+        memoized(1).get();
+        memoized.invalidate(1);
+        memoized(1).get();
+        CHECK(nb_calls == 2);
+    }
+
+    SECTION("exceptions are forwarded, and not cached")
+    {
+        Memoized memoized{[&](const int) -> Task {
+            if(++nb_calls == 1) throw std::runtime_error{"exception"};
+            return Task{1};
+        }};
+        CHECK_THROWS_AS(memoized(1).get(), std::runtime_error);
+        CHECK(*memoized(1).get() == 1);
+    }
+}
@@ -0,0 +1,194 @@
+#include <catch2/catch.hpp>
+
+#include "utilities.hpp"
+
+#include <expected_task/expected_task_operators.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace
+{
+
+/**
+ * @brief a large payload counting its copies.
+ */
+class Buffer
+{
+public:
+    static std::atomic<std::size_t> copies;
+
+    explicit Buffer(const std::size_t size)
+        : m_data(size, 0)
+    {
+    }
+
+    Buffer(const Buffer& other)
+        : m_data{other.m_data}
+    {
+        copies++;
+    }
+
+    Buffer(Buffer&&) noexcept = default;
+
+    Buffer& operator=(const Buffer& other)
+    {
+        m_data = other.m_data;
+        copies++;
+        return *this;
+    }
+
+    Buffer& operator=(Buffer&&) noexcept = default;
+
+    std::size_t size() const
+    {
+        return m_data.size();
+    }
+
+    char& front()
+    {
+        return m_data.front();
+    }
+
+private:
+    std::vector<char> m_data;
+};
+
+std::atomic<std::size_t> Buffer::copies{0};
+
+constexpr std::size_t one_megabyte = 1024 * 1024;
+
+Buffer increment(Buffer buffer)
+{
+    buffer.front()++;
+    return buffer;
+}
+
+template <class Task> auto tenStages(Task task)
+{
+    return std::move(task)
+        .then_map(&increment)
+        .and_then([](Buffer buffer) -> tl::expected<Buffer, std::wstring> { return increment(std::move(buffer)); })
+        .then_map(&increment)
+        .map_error([](std::wstring error) { return error + L" !"; })
+        .then_map(&increment)
+        .or_else([](std::wstring error) -> tl::expected<Buffer, std::wstring> { return tl::make_unexpected(error); })
+        .then_map(&increment)
+        .and_then([](Buffer buffer) -> tl::expected<Buffer, std::wstring> { return increment(std::move(buffer)); })
+        .then_map(&increment)
+        .then_map(&increment);
+}
+
+} // namespace
+
+TEST_CASE("Test consuming chains move the results", "[move]")
+{
+    using Task = expected_task::expected_task<Buffer, std::wstring>;
+    Buffer::copies = 0;
+
+    SECTION("a ready chain of 10 stages on a 1 MB buffer makes no copy")
+    {
+        auto res = tenStages(Task{Buffer{one_megabyte}}).get();
+        REQUIRE(res.has_value());
+        CHECK(res->size() == one_megabyte);
+        CHECK(res->front() == 8);
+        CHECK(Buffer::copies == 0);
+    }
+
+    SECTION("chaining from an lvalue copies it once, and leaves it usable")
+    {
+        const Task source{Buffer{one_megabyte}};
+        auto res = source.then_map(&increment).get();
+        REQUIRE(res.has_value());
+        CHECK(res->front() == 1);
+        CHECK(Buffer::copies == 1);
+        CHECK(source.get()->size() == one_megabyte);
+    }
+
+    SECTION("the operators consume a temporary, and make no copy")
+    {
+        const auto incrementOrFail = [](Buffer buffer) -> tl::expected<Buffer, std::wstring>
+        { return increment(std::move(buffer)); };
+        const auto forward = [](std::wstring error) -> tl::expected<Buffer, std::wstring>
+        { return tl::make_unexpected(std::move(error)); };
+        auto task = (Task{Buffer{one_megabyte}} >= &increment) >>= incrementOrFail;
+        auto res = (std::move(task) || forward).get();
+        REQUIRE(res.has_value());
+        CHECK(res->front() == 2);
+        CHECK(Buffer::copies == 0);
+    }
+
+// pplx::task copies its result into every continuation, only the native engine hands it over : move-only types
+// and asynchronous chains without copies need it
+#ifdef EXPECTED_TASK_NATIVE_BACKEND
+    using UniqueExpected = tl::expected<std::unique_ptr<int>, std::unique_ptr<std::wstring>>;
+    using UniqueTask = expected_task::expected_task<std::unique_ptr<int>, std::unique_ptr<std::wstring>>;
+
+    SECTION("move-only values and errors go through ready chains")
+    {
+        auto res = UniqueTask{std::make_unique<int>(1)}
+                       .then_map(
+                           [](std::unique_ptr<int> value)
+                           {
+                               ++*value;
+                               return value;
+                           })
+                       .and_then([](std::unique_ptr<int>) -> UniqueExpected
+                                 { return tl::make_unexpected(std::make_unique<std::wstring>(L"error")); })
+                       .map_error([](std::unique_ptr<std::wstring> error) { return *error + L" !"; })
+                       .get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error !"s);
+    }
+
+    SECTION("move-only values and errors go through the operators")
+    {
+        const auto incrementValue = [](std::unique_ptr<int> value)
+        {
+            ++*value;
+            return value;
+        };
+        const auto fail = [](std::unique_ptr<int>) -> UniqueExpected
+        { return tl::make_unexpected(std::make_unique<std::wstring>(L"error")); };
+        const auto recover = [](std::unique_ptr<std::wstring> error) -> UniqueExpected
+        { return std::make_unique<int>(static_cast<int>(error->size())); };
+        auto task = (UniqueTask{std::make_unique<int>(1)} >= incrementValue) >>= fail;
+        auto res = (std::move(task) || recover).get();
+        REQUIRE(res.has_value());
+        CHECK(**res == 5);
+    }
+
+    SECTION("an asynchronous chain of 10 stages on a 1 MB buffer makes no copy")
+    {
+        const auto pool = std::make_shared<Testing::FixedThreadPool>(2);
+        const Testing::ScopedAmbientScheduler scoped_scheduler{pool};
+        auto res = tenStages(expected_task::create_task([]() { return Buffer{one_megabyte}; })).get();
+        REQUIRE(res.has_value());
+        CHECK(res->size() == one_megabyte);
+        CHECK(res->front() == 8);
+        CHECK(Buffer::copies == 0);
+    }
+
+    SECTION("a move-only error short-circuits an asynchronous chain")
+    {
+        std::size_t has_been_called = 0;
+        auto res = expected_task::create_task<std::unique_ptr<std::wstring>>([]() { return std::make_unique<int>(1); })
+                       .and_then([](std::unique_ptr<int>) -> UniqueExpected
+                                 { return tl::make_unexpected(std::make_unique<std::wstring>(L"error")); })
+                       .then_map(
+                           [&has_been_called](std::unique_ptr<int> value)
+                           {
+                               has_been_called++;
+                               return value;
+                           })
+                       .get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(*res.error() == L"error"s);
+        CHECK(has_been_called == 0);
+    }
+#endif
+}
@@ -0,0 +1,192 @@
+#include <catch2/catch.hpp>
+
+#include "utilities.hpp"
+
+#include <expected_task/native_task.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory_resource>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace native = expected_task::native;
+
+namespace
+{
+
+/**
+ * @brief counts the blocks allocated from new/delete and not freed yet.
+ */
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    std::atomic<std::size_t> allocated{0};
+    std::atomic<std::size_t> in_use{0};
+
+private:
+    void* do_allocate(const std::size_t bytes, const std::size_t alignment) override
+    {
+        allocated++;
+        in_use++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* const pointer, const std::size_t bytes, const std::size_t alignment) override
+    {
+        in_use--;
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+} // namespace
+
+TEST_CASE("Test the native task engine", "[native]")
+{
+    const auto pool = std::make_shared<Testing::FixedThreadPool>(4);
+    const Testing::ScopedAmbientScheduler scoped_scheduler{pool};
+
+    SECTION("continuations get the result, and returned tasks are unwrapped")
+    {
+        const auto res = native::create_task([]() { return 1; })
+                             .then([](const int value) { return value + 1; })
+                             .then([](const int value) { return native::create_task([value]() { return value * 2; }); })
+                             .then([](const int value) { return pplx::create_task([value]() { return value + 3; }); })
+                             .get();
+        CHECK(res == 7);
+    }
+
+    SECTION("value-based continuations of a faulted task are not scheduled")
+    {
+        std::size_t has_been_called = 0;
+        auto task = native::create_task([]() -> int { throw std::runtime_error{"error"}; });
+        for(int i = 0; i < 10; ++i)
+            task = task.then(
+                [&has_been_called](const int value)
+                {
+                    has_been_called++;
+                    return value;
+                });
+        const auto recovered = task.then(
+            [](native::task<int> faulted)
+            {
+                try
+                {
+                    return faulted.get();
+                }
+                catch(const std::runtime_error&)
+                {
+                    return -1;
+                }
+            });
+        CHECK(recovered.get() == -1);
+        CHECK_THROWS_AS(task.get(), std::runtime_error);
+        CHECK(has_been_called == 0);
+        CHECK(pool->scheduledCount() == 2);
+    }
+
+    SECTION("every continuation runs, even when attached while the task completes")
+    {
+        for(int run = 0; run < 100; ++run)
+        {
+            native::task_completion_event<int> event;
+            const auto task = native::create_task(event);
+            std::atomic<int> sum{0};
+            std::vector<native::task<void>> continuations;
+            std::thread producer{[&event]() { event.set(1); }};
+            for(int i = 0; i < 8; ++i)
+                continuations.push_back(task.then([&sum](const int value) { sum += value; }));
+            producer.join();
+            for(const auto& continuation : continuations)
+                continuation.wait();
+            CHECK(sum == 8);
+        }
+    }
+
+    SECTION("only the first result given to a task_completion_event is kept")
+    {
+        native::task_completion_event<int> event;
+        CHECK(event.set(1));
+        CHECK_FALSE(event.set(2));
+        CHECK_FALSE(event.set_exception(std::make_exception_ptr(std::runtime_error{"error"})));
+        CHECK(native::create_task(event).get() == 1);
+    }
+
+    SECTION("when_all keeps the order of the tasks")
+    {
+        std::vector<native::task<int>> tasks;
+        for(int i = 0; i < 10; ++i)
+            tasks.push_back(native::create_task([i]() { return i; }));
+        const auto res = native::when_all(begin(tasks), end(tasks)).get();
+        REQUIRE(res.size() == 10);
+        for(int i = 0; i < 10; ++i)
+            CHECK(res[i] == i);
+    }
+
+    SECTION("a long chain completing at once doesn't grow the stack")
+    {
+        native::task_completion_event<int> event;
+        auto task = native::create_task(event);
+        for(int i = 0; i < 100000; ++i)
+            task = task.then([](const int value) { return value + 1; });
+        event.set_exception(std::make_exception_ptr(std::runtime_error{"error"}));
+        CHECK_THROWS_AS(task.get(), std::runtime_error);
+    }
+}
+
+TEST_CASE("Test the memory resources of the native task engine", "[native]")
+{
+    const auto pool = std::make_shared<Testing::FixedThreadPool>(4);
+    const Testing::ScopedAmbientScheduler scoped_scheduler{pool};
+
+    SECTION("a chain is allocated from the resource of its first task")
+    {
+        CountingResource resource;
+        auto task = [&resource]()
+        {
+            const native::scoped_memory_resource scoped_resource{&resource};
+            return native::create_task([]() { return 1; });
+        }();
+        CHECK(native::get_memory_resource() == std::pmr::new_delete_resource());
+        for(int i = 0; i < 10; ++i)
+            task = task.then([](const int value) { return value + 1; });
+        CHECK(task.get() == 11);
+        CHECK(resource.allocated == 11);
+        task = {};
+        // the worker running the last stage can still hold it for a moment
+        for(int i = 0; i < 1000 && resource.in_use != 0; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        CHECK(resource.in_use == 0);
+    }
+
+    SECTION("the thread local pool recycles the blocks freed by other threads")
+    {
+        const native::scoped_memory_resource scoped_resource{native::thread_local_pool()};
+        std::vector<native::task<int>> tasks;
+        for(int i = 0; i < 1000; ++i)
+            tasks.push_back(native::create_task([i]() { return i; }).then([](const int value) { return 2 * value; }));
+        const auto res = native::when_all(begin(tasks), end(tasks)).get();
+        REQUIRE(res.size() == 1000);
+        for(int i = 0; i < 1000; ++i)
+            CHECK(res[i] == 2 * i);
+    }
+
+    SECTION("blocks of the thread local pool outlive their thread")
+    {
+        native::task<int> task;
+        std::thread{[&task]()
+                    {
+                        const native::scoped_memory_resource scoped_resource{native::thread_local_pool()};
+                        task = native::task_from_result(1).then([](const int value) { return value + 1; });
+                        task.wait();
+                    }}
+            .join();
+        CHECK(std::move(task).then([](const int value) { return value + 1; }).get() == 3);
+    }
+}
@@ -0,0 +1,141 @@
+#include <catch2/catch.hpp>
+
+#include "utilities.hpp"
+
+#include <expected_task/pipeline.hpp>
+
+#include <memory>
+#include <string>
+
+using namespace std::string_literals;
+
+namespace
+{
+
+using Task = expected_task::expected_task<double, std::wstring>;
+
+Task asyncValue(const double value)
+{
+    return expected_task::create_task([value]() { return value; });
+}
+
+/**
+ * @brief a stage adding one, counting its copies.
+ */
+struct CountedIncrement
+{
+    static inline std::size_t copies = 0;
+
+    CountedIncrement() = default;
+
+    CountedIncrement(const CountedIncrement&)
+    {
+        copies++;
+    }
+
+    CountedIncrement(CountedIncrement&&) = default;
+
+    double operator()(const double value) const
+    {
+        return value + 1;
+    }
+};
+
+} // namespace
+
+TEST_CASE("Test fusing synchronous stages with a pipeline", "[pipeline]")
+{
+
+    SECTION("all the stages run in a single continuation")
+    {
+        const auto pool = std::make_shared<Testing::FixedThreadPool>(2);
+        const Testing::ScopedAmbientScheduler scoped_scheduler{pool};
+        expected_task::backend::task_completion_event<Task::expected_type> event;
+        std::size_t has_been_called = 0;
+        auto task = expected_task::pipeline{Task{expected_task::backend::create_task(event)}}
+                    .then_map(
+                        [&has_been_called](const double value)
+                        {
+                            has_been_called++;
+                            return value + 1;
+                        })
+                    .then_map(
+                        [&has_been_called](const double value)
+                        {
+                            has_been_called++;
+                            return 2 * value;
+                        })
+                    .and_then(Testing::makeFailableTimesTwoLambda(has_been_called))
+                    .run();
+        event.set(Task::expected_type{1.});
+        const auto res = std::move(task).get();
+        CHECK(has_been_called == 3);
+        REQUIRE(res.has_value());
+        CHECK(*res == 8.);
+        // the continuation running the three stages is the only one scheduled
+        CHECK(pool->scheduledCount() == 1);
+    }
+
+    SECTION("an error skips the following value stages")
+    {
+        std::size_t has_been_called = 0;
+        const Task task = expected_task::pipeline{asyncValue(1.)}
+                              .and_then(Testing::makeFailLambda<double, std::wstring>(has_been_called, L"error"s))
+                              .then_map([&has_been_called](const double value)
+                                        {
+                                            has_been_called++;
+                                            return value;
+                                        })
+                              .map_error([](const std::wstring& error) { return error + L"!"; });
+        const auto res = task.get();
+        CHECK(has_been_called == 1);
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error!");
+    }
+
+    SECTION("or_else recovers from an error")
+    {
+        const auto res = expected_task::pipeline{Task{tl::make_unexpected(L"error"s)}}
+                             .or_else([](std::wstring) -> Task::expected_type { return 3.; })
+                             .get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 3.);
+    }
+
+    SECTION("a ready source runs the stages inline")
+    {
+        const auto task = expected_task::pipeline{Task{1.}}.then_map([](const double value) { return value + 1; }).run();
+        REQUIRE(task.is_ready());
+        CHECK(*task.get() == 2.);
+    }
+
+    SECTION("a pipeline built from rvalues moves its stages instead of copying them")
+    {
+        CountedIncrement::copies = 0;
+        const auto res
+            = (expected_task::pipeline{Task{1.}} >= CountedIncrement{} >= CountedIncrement{} >= CountedIncrement{})
+                  .run()
+                  .get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 4.);
+        CHECK(CountedIncrement::copies == 0);
+    }
+
+    SECTION("operators")
+    {
+        std::size_t has_been_called = 0;
+        const auto res = (expected_task::pipeline{asyncValue(1.)} >= [](const double value) { return value + 1; }
+                          >= [](const double value) { return std::to_wstring(value); })
+                             .and_then([](const std::wstring&) -> tl::expected<double, std::wstring>
+                                       { return tl::make_unexpected(L"error"s); })
+                         |= [&has_been_called](const std::wstring& error)
+        {
+            has_been_called++;
+            return error.size();
+        };
+        const auto final_res = res.get();
+        CHECK(has_been_called == 1);
+        REQUIRE_FALSE(final_res.has_value());
+        CHECK(final_res.error() == 5);
+    }
+}
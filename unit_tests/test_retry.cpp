@@ -0,0 +1,136 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/retry.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+using namespace std::chrono_literals;
+using namespace std::string_literals;
+
+namespace
+{
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+using Policy = expected_task::retry_policy<std::wstring>;
+using clock = std::chrono::steady_clock;
+
+/**
+ * @brief fails nb_failures times, and then succeeds, asynchronously.
+ */
+auto failingFactory(std::atomic<int>& nb_calls, const int nb_failures)
+{
+    return [&nb_calls, nb_failures]()
+    {
+        const auto call = ++nb_calls;
+        return expected_task::create_task([]() { return 0; })
+            .and_then([call, nb_failures](int) -> Expected
+                      {
+                          if(call <= nb_failures) return tl::make_unexpected(L"error" + std::to_wstring(call));
+                          return call;
+                      });
+    };
+}
+
+} // namespace
+
+TEST_CASE("Test retrying expected_tasks with retry", "[retry]")
+{
+    std::atomic<int> nb_calls{0};
+
+    SECTION("the factory is called again until it succeeds")
+    {
+        const auto res = expected_task::retry(failingFactory(nb_calls, 2), Policy{.initial_delay = 1ms}).get();
+        CHECK(res == Expected{3});
+        CHECK(nb_calls == 3);
+    }
+
+    SECTION("the last error is given once the attempts are exhausted")
+    {
+        const auto res
+            = expected_task::retry(failingFactory(nb_calls, 10), Policy{.max_attempts = 4, .initial_delay = 1ms}).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error4"s);
+        CHECK(nb_calls == 4);
+    }
+
+    SECTION("errors rejected by the predicate aren't retried")
+    {
+        Policy policy{.initial_delay = 1ms};
+        policy.retry_on = [](const std::wstring& error) { return error != L"error1"s; };
+        const auto res = expected_task::retry(failingFactory(nb_calls, 10), policy).get();
+        CHECK(res.error() == L"error1"s);
+        CHECK(nb_calls == 1);
+    }
+
+    SECTION("the delays grow exponentially")
+    {
+        const auto start = clock::now();
+        const auto res
+            = expected_task::retry(failingFactory(nb_calls, 10),
+                                   Policy{.max_attempts = 4, .initial_delay = 10ms, .multiplier = 2., .jitter = 0.})
+                  .get();
+        CHECK_FALSE(res.has_value());
+        CHECK(clock::now() - start >= 70ms);
+    }
+
+    SECTION("attempts failing right away are retried in a loop, without growing the stack")
+    {
+        const auto res = expected_task::retry(
+                             [&]()
+                             {
+                                 ++nb_calls;
+                                 return Task{tl::make_unexpected(L"error"s)};
+                             },
+                             Policy{.max_attempts = 1'000'000, .initial_delay = 0ms})
+                             .get();
+        CHECK_FALSE(res.has_value());
+        CHECK(nb_calls == 1'000'000);
+    }
+
+    SECTION("exceptions are forwarded without being retried")
+    {
+        const auto res = expected_task::retry(
+            [&]() -> Task
+            {
+                ++nb_calls;
+                throw std::runtime_error{"exception"};
+            });
+        CHECK_THROWS_AS(res.get(), std::runtime_error);
+        CHECK(nb_calls == 1);
+    }
+
+    SECTION("no attempt is made once the token is cancelled")
+    {
+        const pplx::cancellation_token_source source;
+        const auto res = expected_task::retry(
+                             [&]()
+                             {
+                                 if(++nb_calls == 2) source.cancel();
+                                 return Task{tl::make_unexpected(L"error"s)};
+                             },
+                             Policy{.max_attempts = 10, .initial_delay = 1ms}, source.get_token())
+                             .get();
+        CHECK(res.error() == L"cancelled"s);
+        CHECK(nb_calls == 2);
+    }
+
+    SECTION("cancelling the token during a delay finishes the retry right away")
+    {
+        const pplx::cancellation_token_source source;
+        auto task = expected_task::retry(
+            [&]()
+            {
+                ++nb_calls;
+                return Task{tl::make_unexpected(L"error"s)};
+            },
+            Policy{.initial_delay = 1h, .max_delay = 1h, .jitter = 0.}, source.get_token());
+        const auto start = clock::now();
+        source.cancel();
+        CHECK(std::move(task).get().error() == L"cancelled"s);
+        CHECK(clock::now() - start < 1s);
+        CHECK(nb_calls == 1);
+    }
+}
@@ -0,0 +1,141 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/timeout.hpp>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+using namespace std::string_literals;
+
+namespace
+{
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+using Event = expected_task::backend::task_completion_event<Expected>;
+
+Task makePending(const Event& event)
+{
+    return Task{expected_task::backend::create_task(event)};
+}
+
+} // namespace
+
+TEST_CASE("Test bounding expected_tasks with with_timeout", "[timeout]")
+{
+    expected_task::timer_wheel wheel;
+
+    SECTION("a task not done in time finishes with the error")
+    {
+        Event never;
+        const auto res = with_timeout(makePending(never), 10ms, L"timeout", {}, wheel).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"timeout"s);
+    }
+
+    SECTION("a task done in time gives its result, and its timer is cancelled")
+    {
+        Event event;
+        const auto bounded = with_timeout(makePending(event), 1h, L"timeout"s, {}, wheel);
+        CHECK(wheel.size() == 1);
+        event.set(Expected{42});
+        CHECK(*bounded.get() == 42);
+        CHECK(wheel.size() == 0);
+    }
+
+    SECTION("a ready task is returned as is")
+    {
+        const auto bounded = with_timeout(Task{1}, 1h, L"timeout"s, {}, wheel);
+        CHECK(bounded.is_ready());
+        CHECK(wheel.size() == 0);
+    }
+
+    SECTION("exceptions are forwarded")
+    {
+        Event event;
+        const auto bounded = with_timeout(makePending(event), 1h, L"timeout"s, {}, wheel);
+        event.set_exception(std::make_exception_ptr(std::runtime_error{"exception"}));
+        CHECK_THROWS_AS(bounded.get(), std::runtime_error);
+    }
+}
+
+TEST_CASE("Test sharing a deadline between the stages of a chain", "[timeout]")
+{
+    expected_task::timer_wheel wheel;
+    int nb_stages = 0;
+    const auto count = [&nb_stages](const int value)
+    {
+        ++nb_stages;
+        return value + 1;
+    };
+
+    SECTION("the chain finishes with the error of the deadline, and the stages left are skipped")
+    {
+        const expected_task::deadline<> deadline{10ms, L"deadline"s, wheel};
+        Event hanging;
+        auto chain = deadline.bind(makePending(hanging).then_map(count, deadline.options()).then_map(count));
+        const auto res = chain.get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"deadline"s);
+        // the token is cancelled right after the bound chains get the error
+        while(!deadline.has_passed())
+            std::this_thread::yield();
+        hanging.set(Expected{1});
+        CHECK(nb_stages == 0);
+    }
+
+    SECTION("a chain done in time gives its result")
+    {
+        const expected_task::deadline<> deadline{1h, L"deadline"s, wheel};
+        const auto res
+            = deadline.bind(expected_task::create_task([]() { return 1; }, deadline.options()).then_map(count)).get();
+        CHECK(*res == 2);
+        CHECK_FALSE(deadline.has_passed());
+    }
+
+    SECTION("a chain bound once the deadline has passed gets its error right away")
+    {
+        const expected_task::deadline<> deadline{0ms, L"deadline"s, wheel};
+        while(!deadline.has_passed())
+            std::this_thread::yield();
+        Event never;
+        const auto bound = deadline.bind(makePending(never));
+        CHECK(bound.is_ready());
+        CHECK(bound.get().error() == L"deadline"s);
+    }
+
+    SECTION("a chain which finished is forgotten by the deadline, along with its result")
+    {
+        const expected_task::deadline<> deadline{1h, L"deadline"s, wheel};
+        const auto value = std::make_shared<int>(1);
+        {
+            auto bound = deadline.bind(expected_task::create_task([value]() { return value; }));
+            CHECK(*bound.get() == value);
+        }
+        for(int i = 0; i < 1000 && value.use_count() > 1; ++i)
+            std::this_thread::sleep_for(1ms);
+        CHECK(value.use_count() == 1);
+    }
+
+    SECTION("a chain bound to a deadline destroyed before it passes still gets its error, and its stages are skipped")
+    {
+        Event hanging;
+        Task chain;
+        pplx::cancellation_token token = pplx::cancellation_token::none();
+        {
+            const expected_task::deadline<> deadline{10ms, L"deadline"s, wheel};
+            token = deadline.options().get_cancellation_token();
+            chain = deadline.bind(makePending(hanging).then_map(count, deadline.options()).then_map(count));
+        }
+        const auto res = chain.get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"deadline"s);
+        while(!token.is_canceled())
+            std::this_thread::yield();
+        hanging.set(Expected{1});
+        CHECK(nb_stages == 0);
+    }
+}
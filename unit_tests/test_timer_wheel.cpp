@@ -0,0 +1,127 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/timer_wheel.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+using clock = expected_task::timer_wheel::clock;
+
+template <class Predicate> bool waitFor(Predicate&& predicate, const clock::duration timeout = 5s)
+{
+    const auto end = clock::now() + timeout;
+    while(!predicate())
+    {
+        if(clock::now() > end) return false;
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("Test running timers with timer_wheel", "[timer_wheel]")
+{
+    std::mutex mutex;
+    std::vector<int> fired;
+    const auto record = [&](const int id)
+    {
+        return [&, id]()
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            fired.push_back(id);
+        };
+    };
+    const auto nbFired = [&]()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return fired.size();
+    };
+
+    SECTION("timers expire in the order of their deadlines, never early")
+    {
+        expected_task::timer_wheel wheel;
+        const auto start = clock::now();
+        std::atomic<bool> early{false};
+        for(const int delay : {30, 10, 20})
+            wheel.schedule_after(std::chrono::milliseconds{delay},
+                                 [&, delay, record = record(delay)]()
+                                 {
+                                     if(clock::now() < start + std::chrono::milliseconds{delay}) early = true;
+                                     record();
+                                 });
+        REQUIRE(waitFor([&]() { return nbFired() == 3; }));
+        CHECK(fired == std::vector{10, 20, 30});
+        CHECK_FALSE(early);
+        CHECK(wheel.size() == 0);
+    }
+
+    SECTION("a cancelled timer doesn't run")
+    {
+        expected_task::timer_wheel wheel;
+        const auto cancelled = wheel.schedule_after(10ms, record(1));
+        wheel.schedule_after(20ms, record(2));
+        CHECK(wheel.cancel(cancelled));
+        CHECK_FALSE(wheel.cancel(cancelled));
+        REQUIRE(waitFor([&]() { return nbFired() == 1; }));
+        std::this_thread::sleep_for(20ms);
+        CHECK(fired == std::vector{2});
+    }
+
+    SECTION("an expired timer can't be cancelled, even once its node is reused")
+    {
+        expected_task::timer_wheel wheel;
+        const auto expired = wheel.schedule_after(0ms, record(1));
+        REQUIRE(waitFor([&]() { return nbFired() == 1; }));
+        const auto reused = wheel.schedule_after(1h, record(2));
+        CHECK_FALSE(wheel.cancel(expired));
+        CHECK(wheel.size() == 1);
+        CHECK(wheel.cancel(reused));
+    }
+
+    SECTION("timers beyond the first levels are moved down and expire on time")
+    {
+        // 70000 ticks ahead, in the third level
+        expected_task::timer_wheel wheel{10us};
+        const auto start = clock::now();
+        clock::time_point end;
+        wheel.schedule_after(700ms,
+                             [&, record = record(1)]()
+                             {
+                                 end = clock::now();
+                                 record();
+                             });
+        REQUIRE(waitFor([&]() { return nbFired() == 1; }));
+        CHECK(end - start >= 700ms);
+        CHECK(end - start < 1s);
+    }
+
+    SECTION("many timers with random deadlines all expire")
+    {
+        expected_task::timer_wheel wheel{100us};
+        std::mt19937 generator{42};
+        std::uniform_int_distribution<int> delays{0, 100000};
+        std::atomic<int> nb_expired{0};
+        std::atomic<int> nb_early{0};
+        for(int i = 0; i < 10000; ++i)
+        {
+            const auto deadline = clock::now() + std::chrono::microseconds{delays(generator)};
+            wheel.schedule_at(deadline,
+                              [&, deadline]()
+                              {
+                                  if(clock::now() < deadline) ++nb_early;
+                                  ++nb_expired;
+                              });
+        }
+        REQUIRE(waitFor([&]() { return nb_expired == 10000; }));
+        CHECK(nb_early == 0);
+    }
+}
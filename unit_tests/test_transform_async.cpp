@@ -0,0 +1,161 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/transform_async.hpp>
+
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace
+{
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+using Event = expected_task::backend::task_completion_event<Expected>;
+
+/**
+ * @brief a backend answering only when asked to, and keeping track of the requests in flight.
+ */
+struct ManualBackend
+{
+    std::mutex mutex;
+    std::vector<std::pair<int, Event>> pending;
+    std::size_t max_in_flight = 0;
+
+    Task request(const int input)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        Event event;
+        pending.emplace_back(input, event);
+        max_in_flight = std::max(max_in_flight, pending.size());
+        return Task{expected_task::backend::create_task(event)};
+    }
+
+    /**
+     * @brief answers the oldest request with twice its input, or with an error for the given input.
+     */
+    bool answerOldest(const int failing = -1)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        if(pending.empty()) return false;
+        auto [input, event] = pending.front();
+        pending.erase(pending.begin());
+        lock.unlock();
+        event.set(input == failing ? Expected{tl::make_unexpected(L"error"s)} : Expected{2 * input});
+        return true;
+    }
+};
+
+} // namespace
+
+TEST_CASE("Test mapping a range with transform_async", "[transform_async]")
+{
+    SECTION("at most max_in_flight tasks run at once, and the values keep the order of the inputs")
+    {
+        ManualBackend backend;
+        auto task = expected_task::transform_async(std::views::iota(0, 10),
+                                                   [&backend](const int i) { return backend.request(i); }, 3);
+        for(int answered = 0; answered < 10;)
+            if(backend.answerOldest())
+                ++answered;
+            else
+                std::this_thread::yield();
+        const auto res = std::move(task).get();
+        REQUIRE(res.has_value());
+        CHECK(*res == std::vector{0, 2, 4, 6, 8, 10, 12, 14, 16, 18});
+        CHECK(backend.max_in_flight == 3);
+    }
+
+    SECTION("the first error stops starting the inputs")
+    {
+        ManualBackend backend;
+        auto task = expected_task::transform_async(std::views::iota(0, 10),
+                                                   [&backend](const int i) { return backend.request(i); }, 2);
+        backend.answerOldest(0);
+        const auto res = std::move(task).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error"s);
+        CHECK(backend.pending.size() == 1);
+        backend.answerOldest();
+    }
+
+    SECTION("ready tasks are mapped in a loop")
+    {
+        const auto res = expected_task::transform_async(std::views::iota(0, 100000),
+                                                        [](const int i) { return Task{i}; }, 4)
+                             .get();
+        REQUIRE(res.has_value());
+        CHECK(res->size() == 100000);
+        CHECK(res->back() == 99999);
+    }
+
+    SECTION("asynchronous tasks are mapped")
+    {
+        const std::vector<int> inputs{1, 2, 3, 4, 5};
+        const auto res = expected_task::transform_async(
+                             inputs, [](const int i) { return expected_task::create_task([i]() { return i * i; }); }, 2)
+                             .get();
+        REQUIRE(res.has_value());
+        CHECK(*res == std::vector{1, 4, 9, 16, 25});
+        CHECK(inputs.size() == 5);
+    }
+
+    SECTION("the elements of an rvalue range are moved")
+    {
+        std::vector<std::unique_ptr<int>> inputs;
+        inputs.push_back(std::make_unique<int>(1));
+        inputs.push_back(std::make_unique<int>(2));
+        const auto res = expected_task::transform_async(
+                             std::move(inputs), [](std::unique_ptr<int> i) { return Task{*i}; }, 1)
+                             .get();
+        CHECK(res == tl::expected<std::vector<int>, std::wstring>{std::vector{1, 2}});
+    }
+
+    SECTION("the elements of a view over an lvalue container are copied, and left intact")
+    {
+        const auto payload = std::string(64, 'x');
+        std::vector<std::string> inputs{payload, payload};
+        const auto res = expected_task::transform_async(
+                             inputs | std::views::filter([](const std::string&) { return true; }),
+                             [](std::string input) { return Task{static_cast<int>(input.size())}; }, 1)
+                             .get();
+        CHECK(res == tl::expected<std::vector<int>, std::wstring>{std::vector{64, 64}});
+        CHECK(inputs == std::vector{payload, payload});
+    }
+
+    SECTION("an empty range gives no values")
+    {
+        const auto res
+            = expected_task::transform_async(std::vector<int>{}, [](const int i) { return Task{i}; }, 2).get();
+        REQUIRE(res.has_value());
+        CHECK(res->empty());
+    }
+
+    SECTION("an exception thrown by the function is forwarded")
+    {
+        const auto task = expected_task::transform_async(
+            std::views::iota(0, 3), [](int) -> Task { throw std::runtime_error{"exception"}; }, 2);
+        CHECK_THROWS_AS(task.get(), std::runtime_error);
+    }
+
+    SECTION("once the token is cancelled, no other input is started")
+    {
+        ManualBackend backend;
+        const pplx::cancellation_token_source source;
+        auto task = expected_task::transform_async(std::views::iota(0, 10),
+                                                   [&backend](const int i) { return backend.request(i); }, 2,
+                                                   pplx::task_options{source.get_token()});
+        source.cancel();
+        backend.answerOldest();
+        const auto res = std::move(task).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"cancelled"s);
+        CHECK(backend.pending.size() == 1);
+        backend.answerOldest();
+    }
+}
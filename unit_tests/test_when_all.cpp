@@ -1,9 +1,17 @@
 #include <catch2/catch.hpp>
 
 #include <expected_task/when_all.hpp>
+#include <expected_task/work_stealing_executor.hpp>
 
 #include <algorithm>
+#include <list>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <system_error>
+#include <tuple>
 #include <vector>
 
 using namespace std::string_literals;
@@ -23,6 +31,14 @@ Task makeError(std::wstring error)
     return tl::make_unexpected(std::move(error));
 }
 
+/**
+ * @brief a task finishing only once its event is set.
+ */
+Task makePending(const expected_task::backend::task_completion_event<Expected>& event)
+{
+    return Task{expected_task::backend::create_task(event)};
+}
+
 } // namespace
 
 TEST_CASE("Test expected_task chaining with when_all", "[when_all]")
@@ -103,3 +119,314 @@ TEST_CASE("Test expected_task chaining with the && operator", "[when_all]")
         CHECK(res.error() == error1 + L" && " + error2);
     }
 }
+
+TEST_CASE("Test the policies of when_all", "[when_all]")
+{
+    SECTION("aggregate_errors stacks all the errors, as by default")
+    {
+        std::vector<Task> tasks({makeTask(1), makeError(L"error1"s), makeError(L"error2"s)});
+        const auto res = when_all(tasks, expected_task::aggregate_errors<std::wstring>{L" || "s}).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error1 || error2"s);
+    }
+
+    SECTION("aggregate_errors stacks the errors of 10000 tasks")
+    {
+        std::vector<Task> tasks;
+        for(std::size_t i = 0; i < 10000; ++i)
+            tasks.push_back(makeError(L"error"s));
+        const auto res = when_all(std::move(tasks), expected_task::aggregate_errors<std::wstring>{L","s}).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error().size() == 10000 * 5 + 9999);
+        CHECK(res.error().starts_with(L"error,error,"));
+    }
+
+    SECTION("collect_errors gives all the errors in the order of the tasks")
+    {
+        std::vector<Task> tasks({makeError(L"error1"s), makeTask(1), makeError(L"error2"s)});
+        const auto res = when_all(tasks, expected_task::collect_errors{}).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == std::vector<std::wstring>{L"error1"s, L"error2"s});
+    }
+
+    SECTION("first_error keeps the first error code")
+    {
+        using CodeTask = expected_task::expected_task<int, std::error_code>;
+        std::vector<CodeTask> tasks({CodeTask{1},
+                                     CodeTask{tl::make_unexpected(std::make_error_code(std::errc::timed_out))},
+                                     CodeTask{tl::make_unexpected(std::make_error_code(std::errc::io_error))}});
+        const auto res = when_all(tasks, expected_task::first_error{}).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == std::errc::timed_out);
+    }
+
+    SECTION("any callable taking the errors aggregates them")
+    {
+        std::vector<Task> tasks({makeError(L"error1"s), makeTask(1), makeError(L"error2"s)});
+        const auto res = when_all(tasks, [](std::vector<std::wstring> errors) { return errors.size(); }).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == 2);
+    }
+
+    SECTION("an aggregator is only called on failure")
+    {
+        std::vector<Task> tasks({makeTask(1), makeTask(2)});
+        const auto res = when_all(tasks, expected_task::collect_errors{}).get();
+        REQUIRE(res.has_value());
+        CHECK(res == std::vector<int>{1, 2});
+    }
+
+    SECTION("fail_fast keeps the order of the values")
+    {
+        const std::vector<int> values{1, 2, 3, 4, 5};
+        std::vector<Task> tasks;
+        for(const auto value : values)
+            tasks.push_back(expected_task::create_task([value]() { return value; }));
+        const auto res = when_all(tasks, expected_task::fail_fast{}).get();
+        REQUIRE(res.has_value());
+        CHECK(res == values);
+    }
+
+    SECTION("fail_fast completes with the first error without waiting for the other tasks")
+    {
+        expected_task::backend::task_completion_event<Expected> slow;
+        std::vector<Task> tasks({makePending(slow), makeError(L"error"s), makePending(slow)});
+        const auto res = when_all(tasks, expected_task::fail_fast{}).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error"s);
+        slow.set(Expected{1});
+    }
+
+    SECTION("fail_fast cancels the remaining tasks on failure")
+    {
+        expected_task::backend::task_completion_event<Expected> slow;
+        const pplx::cancellation_token_source cancel_remaining;
+        std::vector<Task> tasks({makePending(slow), makeError(L"error"s)});
+        const auto res = when_all(tasks, expected_task::fail_fast{cancel_remaining}).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(cancel_remaining.get_token().is_canceled());
+        slow.set(Expected{1});
+    }
+
+    SECTION("fail_fast doesn't cancel anything on success")
+    {
+        const pplx::cancellation_token_source cancel_remaining;
+        std::vector<Task> tasks({makeTask(1), makeTask(2)});
+        const auto res = when_all(tasks, expected_task::fail_fast{cancel_remaining}).get();
+        REQUIRE(res.has_value());
+        CHECK_FALSE(cancel_remaining.get_token().is_canceled());
+    }
+
+    SECTION("fail_fast forwards the first exception")
+    {
+        std::vector<Task> tasks(
+            {makeTask(1), expected_task::create_task([]() -> int { throw std::runtime_error{"exception"}; })});
+        CHECK_THROWS_AS(when_all(tasks, expected_task::fail_fast{}).get(), std::runtime_error);
+    }
+}
+
+TEST_CASE("Test cancelling when_all", "[when_all]")
+{
+    const pplx::cancellation_token_source source;
+    const pplx::task_options options{source.get_token()};
+    expected_task::backend::task_completion_event<Expected> event;
+
+    SECTION("the errors are aggregated into the cancellation error once the tasks are done")
+    {
+        auto task = when_all(std::vector<Task>{makePending(event), makeTask(2)}, options);
+        source.cancel();
+        event.set(Expected{1});
+        CHECK(std::move(task).get().error() == L"cancelled"s);
+    }
+
+    SECTION("with a buffer, the values of the tasks finishing are dropped")
+    {
+        std::vector<int> output(2);
+        auto task = when_all(std::vector<Task>{makePending(event), makeTask(2)}, std::span{output}, options);
+        source.cancel();
+        event.set(Expected{1});
+        CHECK(std::move(task).get().error() == L"cancelled"s);
+        CHECK(output[0] == 0);
+    }
+
+    SECTION("fail_fast completes with the cancellation error as the next task finishes")
+    {
+        expected_task::backend::task_completion_event<Expected> slow;
+        auto task = when_all(std::vector<Task>{makePending(event), makePending(slow)}, expected_task::fail_fast{},
+                             options);
+        source.cancel();
+        event.set(Expected{1});
+        CHECK(std::move(task).get().error() == L"cancelled"s);
+        slow.set(Expected{2});
+    }
+}
+
+TEST_CASE("Test when_all with tasks of different types", "[when_all]")
+{
+    using StringTask = expected_task::expected_task<std::string, std::wstring>;
+    using DoubleTask = expected_task::expected_task<double, std::wstring>;
+
+    SECTION("the values are gathered in a tuple, in order")
+    {
+        const auto res = when_all(expected_task::create_task([]() { return 1; }),
+                                  expected_task::create_task([]() { return "settings"s; }), DoubleTask{2.5})
+                             .get();
+        REQUIRE(res.has_value());
+        CHECK(*res == std::tuple{1, "settings"s, 2.5});
+    }
+
+    SECTION("ready tasks give a ready result")
+    {
+        const auto task = when_all(makeTask(1), StringTask{"settings"s});
+        CHECK(task.is_ready());
+        CHECK(*task.get() == std::tuple{1, "settings"s});
+    }
+
+    SECTION("the first error in the order of the tasks is kept")
+    {
+        expected_task::backend::task_completion_event<Expected> event;
+        auto task = when_all(makePending(event), StringTask{tl::make_unexpected(L"error2"s)}, makeError(L"error3"s));
+        event.set(Expected{tl::make_unexpected(L"error1"s)});
+        const auto res = std::move(task).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error1"s);
+    }
+
+    SECTION("an exception is forwarded once all the tasks are done")
+    {
+        const auto task = when_all(expected_task::create_task([]() -> int { throw std::runtime_error{"exception"}; }),
+                                   DoubleTask{1.});
+        CHECK_THROWS_AS(task.get(), std::runtime_error);
+    }
+    SECTION("the result runs on the scheduler of the options, even if the tasks are ready")
+    {
+        const auto executor = std::make_shared<expected_task::work_stealing_executor>(1);
+        const auto check_thread = [&executor](std::tuple<int, std::string> values)
+        {
+            CHECK(executor->owns_current_thread());
+            return values;
+        };
+        expected_task::backend::task_completion_event<Expected> event;
+        auto pending = when_all(pplx::task_options{executor}, makePending(event), StringTask{"settings"s})
+                           .then_map(check_thread);
+        event.set(Expected{1});
+        CHECK(*std::move(pending).get() == std::tuple{1, "settings"s});
+        const auto ready
+            = when_all(pplx::task_options{executor}, makeTask(2), StringTask{"settings"s}).then_map(check_thread).get();
+        CHECK(*ready == std::tuple{2, "settings"s});
+    }
+
+    SECTION("once the token of the options is cancelled, the result is the cancellation error")
+    {
+        const pplx::cancellation_token_source source;
+        expected_task::backend::task_completion_event<Expected> event;
+        auto task = when_all(pplx::task_options{source.get_token()}, makePending(event), DoubleTask{1.});
+        source.cancel();
+        event.set(Expected{1});
+        CHECK(std::move(task).get().error() == L"cancelled"s);
+        CHECK(when_all(pplx::task_options{source.get_token()}, makeTask(1), DoubleTask{1.}).get().error()
+              == L"cancelled"s);
+    }
+}
+
+TEST_CASE("Test when_all over any range", "[when_all]")
+{
+    SECTION("spans, lists and views are accepted")
+    {
+        std::vector<Task> tasks({makeTask(1), makeTask(2)});
+        CHECK(*when_all(std::span{tasks}).get() == std::vector{1, 2});
+        CHECK(tasks[0].get() == Expected{1});
+        CHECK(*when_all(std::list<Task>{makeTask(1), makeTask(2)}).get() == std::vector{1, 2});
+        CHECK(*when_all(std::views::iota(0, 3) | std::views::transform(&makeTask)).get() == std::vector{0, 1, 2});
+    }
+
+    SECTION("the values are written into the buffer of the caller")
+    {
+        std::vector<int> output(3);
+        const auto res
+            = when_all(std::vector<Task>{makeTask(1), expected_task::create_task([]() { return 2; }), makeTask(3)},
+                       std::span{output})
+                  .get();
+        REQUIRE(res.has_value());
+        CHECK(res->data() == output.data());
+        CHECK(output == std::vector{1, 2, 3});
+    }
+
+    SECTION("with a buffer, the errors are stacked in the order of the tasks")
+    {
+        expected_task::backend::task_completion_event<Expected> event;
+        std::vector<int> output(3);
+        auto task
+            = when_all(std::vector<Task>{makePending(event), makeTask(2), makeError(L"error2"s)}, std::span{output});
+        event.set(Expected{tl::make_unexpected(L"error1"s)});
+        const auto res = std::move(task).get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error1 && error2"s);
+        CHECK(output[1] == 2);
+    }
+
+    SECTION("with a buffer bigger than the range, only the elements written to are given back")
+    {
+        std::vector<int> output(4, -1);
+        const auto res = when_all(std::vector<Task>{makeTask(1), expected_task::create_task([]() { return 2; })},
+                                  std::span{output})
+                             .get();
+        REQUIRE(res.has_value());
+        CHECK(res->data() == output.data());
+        CHECK(std::vector(res->begin(), res->end()) == std::vector{1, 2});
+        CHECK(output == std::vector{1, 2, -1, -1});
+        const auto empty = when_all(std::vector<Task>{}, std::span{output}).get();
+        REQUIRE(empty.has_value());
+        CHECK(empty->empty());
+    }
+
+    SECTION("a buffer smaller than the range is rejected")
+    {
+        std::vector<int> output(1);
+        CHECK_THROWS_AS(when_all(std::vector<Task>{makeTask(1), makeTask(2)}, std::span{output}),
+                        std::invalid_argument);
+    }
+
+    SECTION("with a buffer, the errors are turned into one by the aggregator given")
+    {
+        std::vector<int> output(3);
+        const auto res = when_all(std::vector<Task>{makeError(L"error1"s), makeTask(2), makeError(L"error2"s)},
+                                  std::span{output}, expected_task::collect_errors{})
+                             .get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == std::vector{L"error1"s, L"error2"s});
+        CHECK(output[1] == 2);
+    }
+
+    SECTION("the tasks of a view over an lvalue container are copied, and left intact")
+    {
+        using StringTask = expected_task::expected_task<std::string, std::wstring>;
+        const auto payload = std::string(64, 'x');
+        std::vector<StringTask> tasks{StringTask{payload}, StringTask{payload}};
+        const auto res = when_all(tasks | std::views::filter([](const StringTask&) { return true; })).get();
+        REQUIRE(res.has_value());
+        CHECK(*res == std::vector{payload, payload});
+        CHECK(tasks[0].get() == payload);
+        CHECK(tasks[1].get() == payload);
+    }
+
+// pplx::task copies the results it gathers, only the native engine moves them
+#ifdef EXPECTED_TASK_NATIVE_BACKEND
+    SECTION("the values of an rvalue range are moved")
+    {
+        using UniqueTask = expected_task::expected_task<std::unique_ptr<int>, std::wstring>;
+        std::vector<UniqueTask> tasks;
+        tasks.emplace_back(std::make_unique<int>(1));
+        tasks.emplace_back(expected_task::create_task([]() { return std::make_unique<int>(2); }));
+        const auto res = when_all(std::move(tasks)).get();
+        REQUIRE(res.has_value());
+        CHECK(*(*res)[1] == 2);
+
+        std::vector<std::unique_ptr<int>> output(1);
+        std::vector<UniqueTask> others;
+        others.emplace_back(std::make_unique<int>(3));
+        CHECK(when_all(std::move(others), std::span{output}).get().has_value());
+        CHECK(*output[0] == 3);
+    }
+#endif
+}
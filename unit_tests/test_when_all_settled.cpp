@@ -0,0 +1,108 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/when_all_settled.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace
+{
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+
+Task makeError(std::wstring error)
+{
+    return tl::make_unexpected(std::move(error));
+}
+
+} // namespace
+
+TEST_CASE("Test settling a batch of expected_tasks with when_all_settled", "[when_all_settled]")
+{
+    SECTION("the values are kept along with the errors, in order")
+    {
+        std::vector<Task> tasks({Task{1}, makeError(L"error1"s), expected_task::create_task([]() { return 3; }),
+                                 makeError(L"error2"s)});
+        const auto res = when_all_settled(tasks).get();
+        REQUIRE(res.has_value());
+        CHECK(res->size() == 4);
+        CHECK_FALSE(res->all_succeeded());
+        CHECK(std::vector(res->values().begin(), res->values().end()) == std::vector{1, 3});
+        CHECK(res->failed_indices() == std::vector<std::size_t>{1, 3});
+        CHECK(res->failures()[1].second == L"error2"s);
+    }
+
+    SECTION("each result can be read back by index")
+    {
+        std::vector<Task> tasks({makeError(L"error"s), Task{1}, Task{2}});
+        const auto res = when_all_settled(tasks).get();
+        REQUIRE(res.has_value());
+        CHECK_FALSE(res->succeeded(0));
+        CHECK(res->succeeded(2));
+        CHECK((*res)[0] == Expected{tl::make_unexpected(L"error"s)});
+        CHECK((*res)[2] == Expected{2});
+    }
+
+    SECTION("the results are kept in the order of the tasks, whatever the order they finish in")
+    {
+        expected_task::backend::task_completion_event<Expected> first;
+        expected_task::backend::task_completion_event<Expected> second;
+        expected_task::backend::task_completion_event<Expected> third;
+        auto task = when_all_settled(std::vector<Task>{Task{expected_task::backend::create_task(first)},
+                                                       Task{expected_task::backend::create_task(second)},
+                                                       Task{expected_task::backend::create_task(third)}});
+        third.set(Expected{3});
+        second.set(Expected{tl::make_unexpected(L"error"s)});
+        first.set(Expected{1});
+        const auto res = std::move(task).get();
+        REQUIRE(res.has_value());
+        CHECK(std::vector(res->values().begin(), res->values().end()) == std::vector{1, 3});
+        CHECK(res->failed_indices() == std::vector<std::size_t>{1});
+        CHECK((*res)[1] == Expected{tl::make_unexpected(L"error"s)});
+    }
+
+    SECTION("an empty batch settles right away")
+    {
+        const auto res = when_all_settled(std::vector<Task>{}).get();
+        REQUIRE(res.has_value());
+        CHECK(res->empty());
+        CHECK(res->all_succeeded());
+    }
+
+    SECTION("an exception is forwarded")
+    {
+        std::vector<Task> tasks(
+            {Task{1}, expected_task::create_task([]() -> int { throw std::runtime_error{"exception"}; })});
+        CHECK_THROWS_AS(when_all_settled(tasks).get(), std::runtime_error);
+    }
+}
+
+TEST_CASE("Test cancelling when_all_settled", "[when_all_settled]")
+{
+    expected_task::backend::task_completion_event<Expected> event;
+    const pplx::cancellation_token_source source;
+    auto task = when_all_settled(std::vector<Task>{Task{expected_task::backend::create_task(event)}, Task{2}},
+                                 pplx::task_options{source.get_token()});
+    source.cancel();
+    event.set(Expected{1});
+    CHECK(std::move(task).get().error() == L"cancelled"s);
+}
+
+TEST_CASE("Test the compact storage of settled_results", "[when_all_settled]")
+{
+    SECTION("the bitmap spans several words")
+    {
+        expected_task::settled_results<int, std::wstring> results;
+        for(int i = 0; i < 200; ++i)
+            results.push_back(i % 3 == 0 ? Expected{tl::make_unexpected(std::to_wstring(i))} : Expected{i});
+        CHECK(results.size() == 200);
+        CHECK(results.values().size() == 133);
+        CHECK(results.failures().size() == 67);
+        CHECK(results[130] == Expected{130});
+        CHECK(results[198] == Expected{tl::make_unexpected(L"198"s)});
+        CHECK(results[199] == Expected{199});
+    }
+}
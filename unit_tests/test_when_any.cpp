@@ -0,0 +1,175 @@
+#include <catch2/catch.hpp>
+
+#include <expected_task/when_any.hpp>
+#include <expected_task/work_stealing_executor.hpp>
+
+#include <list>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace
+{
+using Task = expected_task::expected_task<int, std::wstring>;
+using Expected = typename Task::expected_type;
+using Event = expected_task::backend::task_completion_event<Expected>;
+
+Task makePending(const Event& event)
+{
+    return Task{expected_task::backend::create_task(event)};
+}
+
+} // namespace
+
+TEST_CASE("Test racing expected_tasks with when_any", "[when_any]")
+{
+    SECTION("the first task to finish wins, even with an error")
+    {
+        Event slow, fast;
+        const auto task = when_any(std::vector<Task>{makePending(slow), makePending(fast)});
+        fast.set(Expected{tl::make_unexpected(L"error"s)});
+        const auto res = task.get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error"s);
+        slow.set(Expected{1});
+    }
+
+    SECTION("a ready task wins right away, and the losers are cancelled")
+    {
+        Event slow;
+        const pplx::cancellation_token_source cancel_losers;
+        const auto task = when_any(std::vector<Task>{makePending(slow), Task{2}}, {}, cancel_losers);
+        CHECK(task.is_ready());
+        CHECK(*task.get() == 2);
+        CHECK(cancel_losers.get_token().is_canceled());
+        slow.set(Expected{1});
+    }
+
+    SECTION("a ready task wins on the scheduler of the options, once their token is checked")
+    {
+        Event slow;
+        const auto executor = std::make_shared<expected_task::work_stealing_executor>(1);
+        const auto res = when_any(std::vector<Task>{makePending(slow), Task{2}}, executor)
+                             .then_map(
+                                 [&executor](const int value)
+                                 {
+                                     CHECK(executor->owns_current_thread());
+                                     return value;
+                                 })
+                             .get();
+        CHECK(res == Expected{2});
+        const pplx::cancellation_token_source source;
+        source.cancel();
+        const auto cancelled
+            = when_any(std::vector<Task>{makePending(slow), Task{2}}, pplx::task_options{source.get_token()});
+        CHECK(cancelled.get().error() == L"cancelled"s);
+        slow.set(Expected{1});
+    }
+
+    SECTION("any range of tasks is accepted, but not an empty one")
+    {
+        Event slow, fast;
+        const auto task = when_any(std::list<Task>{makePending(slow), makePending(fast)});
+        fast.set(Expected{2});
+        CHECK(*task.get() == 2);
+        slow.set(Expected{1});
+        const auto ready = std::views::iota(0, 3) | std::views::transform([](const int i) { return Task{i}; });
+        CHECK(*expected_task::when_any(ready).get() == 0);
+        CHECK_THROWS_AS(when_any(std::vector<Task>{}), std::invalid_argument);
+    }
+
+    SECTION("a loser throwing once the race is won has its exception observed")
+    {
+        Event slow, fast;
+        const auto task = when_any(std::vector<Task>{makePending(slow), makePending(fast)});
+        fast.set(Expected{2});
+        CHECK(*task.get() == 2);
+        slow.set_exception(std::make_exception_ptr(std::runtime_error{"exception"}));
+    }
+
+    SECTION("once the token is cancelled, the next task to finish completes the race with the cancellation error")
+    {
+        Event slow, fast;
+        const pplx::cancellation_token_source source;
+        const auto task = when_any(std::vector<Task>{makePending(slow), makePending(fast)},
+                                   pplx::task_options{source.get_token()});
+        source.cancel();
+        fast.set(Expected{2});
+        CHECK(task.get().error() == L"cancelled"s);
+        slow.set(Expected{1});
+    }
+}
+
+TEST_CASE("Test racing expected_tasks with first_success", "[when_any]")
+{
+    SECTION("the first success wins, whatever the errors before it")
+    {
+        Event failing, succeeding, slow;
+        const pplx::cancellation_token_source cancel_losers;
+        const auto task = first_success(
+            std::vector<Task>{makePending(failing), makePending(succeeding), makePending(slow)}, {}, L" && "s,
+            cancel_losers);
+        failing.set(Expected{tl::make_unexpected(L"error"s)});
+        succeeding.set(Expected{2});
+        const auto res = task.get();
+        REQUIRE(res.has_value());
+        CHECK(*res == 2);
+        CHECK(cancel_losers.get_token().is_canceled());
+        slow.set(Expected{3});
+    }
+
+    SECTION("when every task fails, the errors are stacked in the order of the tasks")
+    {
+        Event first, second;
+        const auto task = first_success(std::vector<Task>{makePending(first), makePending(second)});
+        second.set(Expected{tl::make_unexpected(L"error2"s)});
+        first.set(Expected{tl::make_unexpected(L"error1"s)});
+        const auto res = task.get();
+        REQUIRE_FALSE(res.has_value());
+        CHECK(res.error() == L"error1 && error2"s);
+    }
+
+    SECTION("the errors are turned into one by the aggregator given")
+    {
+        Event first, second;
+        const auto task = first_success(std::vector<Task>{makePending(first), makePending(second)},
+                                        expected_task::collect_errors{});
+        second.set(Expected{tl::make_unexpected(L"error2"s)});
+        first.set(Expected{tl::make_unexpected(L"error1"s)});
+        CHECK(task.get().error() == std::vector{L"error1"s, L"error2"s});
+        const std::vector<Task> failing{Task{tl::make_unexpected(L"error1"s)}, Task{tl::make_unexpected(L"error2"s)}};
+        CHECK(first_success(failing, expected_task::first_error{}).get().error() == L"error1"s);
+    }
+
+    SECTION("any range of tasks is accepted, but not an empty one")
+    {
+        const std::vector<Task> tasks{Task{tl::make_unexpected(L"error"s)}, Task{2}, Task{3}};
+        CHECK(*first_success(tasks | std::views::drop(1)).get() == 2);
+        CHECK(*first_success(std::list<Task>{tasks[0], tasks[2]}).get() == 3);
+        CHECK_THROWS_AS(first_success(std::vector<Task>{}), std::invalid_argument);
+    }
+
+    SECTION("an exception is rethrown only if every task failed")
+    {
+        const auto throwing = expected_task::create_task([]() -> int { throw std::runtime_error{"exception"}; });
+        CHECK(*first_success(std::vector<Task>{throwing, Task{1}}).get() == 1);
+        CHECK_THROWS_AS(first_success(std::vector<Task>{throwing, Task{tl::make_unexpected(L"error"s)}}).get(),
+                        std::runtime_error);
+    }
+
+    SECTION("once the token is cancelled, the next task to finish completes the race with the cancellation error")
+    {
+        Event slow, fast;
+        const pplx::cancellation_token_source source;
+        const auto task = first_success(std::vector<Task>{makePending(slow), makePending(fast)},
+                                        pplx::task_options{source.get_token()});
+        source.cancel();
+        fast.set(Expected{2});
+        CHECK(task.get().error() == L"cancelled"s);
+        slow.set(Expected{1});
+    }
+}
@@ -2,6 +2,13 @@
 
 #include <expected_task/expected_task.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace Testing
 {
 
@@ -41,6 +48,101 @@ inline auto makeFailableTimesTwoLambdaET(std::size_t& has_been_called)
     };
 }
 
+/**
+ * @brief minimal fixed-size pplx scheduler, used to run tests on a pool of a known size
+ */
+class FixedThreadPool : public pplx::scheduler_interface
+{
+public:
+    explicit FixedThreadPool(const std::size_t nb_threads)
+        : m_queue{std::make_shared<Queue>()}
+    {
+        for(std::size_t i = 0; i < nb_threads; ++i)
+            m_threads.emplace_back([queue = m_queue]() { run(*queue); });
+    }
+
+    ~FixedThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_queue->mutex};
+            m_queue->stopping = true;
+        }
+        m_queue->condition.notify_all();
+        // the last reference to the scheduler can be released by one of its own jobs
+        for(auto& thread : m_threads)
+            if(thread.get_id() == std::this_thread::get_id())
+                thread.detach();
+            else
+                thread.join();
+    }
+
+    void schedule(pplx::TaskProc_t proc, void* param) override
+    {
+        m_nb_scheduled.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock{m_queue->mutex};
+            m_queue->jobs.emplace_back(proc, param);
+        }
+        m_queue->condition.notify_one();
+    }
+
+    /**
+     * @brief number of jobs scheduled on the pool since its creation
+     */
+    std::size_t scheduledCount() const
+    {
+        return m_nb_scheduled.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<std::pair<pplx::TaskProc_t, void*>> jobs;
+        bool stopping = false;
+    };
+
+    std::shared_ptr<Queue> m_queue;
+    std::vector<std::thread> m_threads;
+    std::atomic<std::size_t> m_nb_scheduled{0};
+
+    static void run(Queue& queue)
+    {
+        while(true)
+        {
+            std::unique_lock<std::mutex> lock{queue.mutex};
+            queue.condition.wait(lock, [&queue]() { return queue.stopping || !queue.jobs.empty(); });
+            if(queue.jobs.empty()) return;
+            const auto [proc, param] = queue.jobs.front();
+            queue.jobs.pop_front();
+            lock.unlock();
+            proc(param);
+        }
+    }
+};
+
+/**
+ * @brief replaces pplx's ambient scheduler for the lifetime of the object
+ */
+class ScopedAmbientScheduler
+{
+public:
+    explicit ScopedAmbientScheduler(std::shared_ptr<pplx::scheduler_interface> scheduler)
+        : m_previous{pplx::get_ambient_scheduler()}
+    {
+        pplx::set_ambient_scheduler(std::move(scheduler));
+    }
+
+    ~ScopedAmbientScheduler()
+    {
+        pplx::set_ambient_scheduler(std::move(m_previous));
+    }
+
+private:
+    std::shared_ptr<pplx::scheduler_interface> m_previous;
+};
+
 template <class T, class Err> inline auto makeFailLambda(std::size_t& has_been_called, Err error)
 {
     return [&has_been_called, e = std::move(error)](double) mutable -> tl::expected<T, Err>